@@ -6,10 +6,14 @@
 // in the file LICENSE in the source distribution.
 //
 
+#include <cryptcpp/codec_literal.hpp>
 #include <cryptcpp/factory.hpp>
+#include <openssl/evp.h>
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 void codec_test(const std::string &raw,
                 cryptcpp::codec::codec_algorithm codec_algo,
@@ -42,11 +46,320 @@ void codec_test(const std::string &raw,
             << dec_buf << std::endl;
 }
 
+void codec_error_test(const std::string &enc,
+                      cryptcpp::codec::codec_algorithm codec_algo,
+                      const std::string &test_name) {
+  std::cout << std::endl
+            << "____________________________________________________"
+            << std::endl;
+  auto fact = cryptcpp::factory::get_factory();
+  std::shared_ptr<cryptcpp::codec> my_codec(fact->create_codec(codec_algo));
+
+  // Malformed input fails like a short output buffer does.
+  char dec_buf[my_codec->get_max_decoded_buf_len(enc.size())];
+  std::cout << test_name << " decoding of \"" << enc << "\": ";
+  try {
+    const ssize_t dec_len =
+        my_codec->decode(enc.c_str(), enc.size(), dec_buf, sizeof(dec_buf));
+    std::cout << std::string(dec_buf, dec_len) << std::endl;
+  } catch (const std::exception &e) {
+    std::cout << e.what() << std::endl;
+  }
+}
+
+void codec_in_place_test(const std::string &raw,
+                         cryptcpp::codec::codec_algorithm codec_algo,
+                         const std::string &test_name) {
+  std::cout << std::endl
+            << "____________________________________________________"
+            << std::endl;
+  auto fact = cryptcpp::factory::get_factory();
+  std::shared_ptr<cryptcpp::codec> my_codec(fact->create_codec(codec_algo));
+
+  // Decode into the very buffer holding the encoded data.
+  std::vector<char> buf(my_codec->get_max_encoded_buf_len(raw.size()));
+  const ssize_t enc_len =
+      my_codec->encode(raw.c_str(), raw.size(), buf.data(), buf.size());
+  const ssize_t dec_len =
+      my_codec->decode(buf.data(), enc_len, buf.data(), enc_len);
+  std::cout << test_name << " in place decoded data length: " << dec_len
+            << " data:" << std::endl
+            << std::string(buf.data(), dec_len) << std::endl;
+}
+
+void codec_stream_test(const std::string &raw,
+                       cryptcpp::codec::codec_algorithm codec_algo,
+                       const std::string &test_name, size_t chunk_len) {
+  std::cout << std::endl
+            << "____________________________________________________"
+            << std::endl;
+  auto fact = cryptcpp::factory::get_factory();
+  std::shared_ptr<cryptcpp::codec> my_codec(fact->create_codec(codec_algo));
+
+  // Encode the raw string in chunks.
+  std::string enc;
+  char enc_buf[my_codec->get_max_encoded_buf_len(chunk_len)];
+  for (size_t pos = 0; pos < raw.size(); pos += chunk_len) {
+    const size_t len = std::min(chunk_len, raw.size() - pos);
+    const ssize_t enc_len = my_codec->encode_update(
+        raw.c_str() + pos, len, enc_buf, sizeof(enc_buf));
+    enc.append(enc_buf, enc_len);
+  }
+  enc.append(enc_buf, my_codec->encode_final(enc_buf, sizeof(enc_buf)));
+  std::cout << test_name << " stream encoded data length: " << enc.size()
+            << " data:" << std::endl
+            << enc << std::endl;
+
+  // Decode the encoded string back in chunks.
+  std::string dec;
+  char dec_buf[my_codec->get_max_decoded_buf_len(chunk_len + 8)];
+  for (size_t pos = 0; pos < enc.size(); pos += chunk_len) {
+    const size_t len = std::min(chunk_len, enc.size() - pos);
+    const ssize_t dec_len = my_codec->decode_update(
+        enc.c_str() + pos, len, dec_buf, sizeof(dec_buf));
+    dec.append(dec_buf, dec_len);
+  }
+  dec.append(dec_buf, my_codec->decode_final(dec_buf, sizeof(dec_buf)));
+  std::cout << test_name << " stream decoded data length: " << dec.size()
+            << " data:" << std::endl
+            << dec << std::endl;
+}
+
+void codec_batch_test(const std::vector<std::string> &raws,
+                      cryptcpp::codec::codec_algorithm codec_algo,
+                      const std::string &test_name) {
+  std::cout << std::endl
+            << "____________________________________________________"
+            << std::endl;
+  auto fact = cryptcpp::factory::get_factory();
+  std::shared_ptr<cryptcpp::codec> my_codec(fact->create_codec(codec_algo));
+
+  // Encode all the raw strings into one arena.
+  std::vector<const char *> raw_bufs;
+  std::vector<size_t> raw_lens;
+  size_t enc_buf_len = 0;
+  for (const auto &raw : raws) {
+    raw_bufs.push_back(raw.c_str());
+    raw_lens.push_back(raw.size());
+    enc_buf_len += my_codec->get_max_encoded_buf_len(raw.size());
+  }
+  std::vector<char> enc_buf(enc_buf_len);
+  std::vector<size_t> enc_offsets(raws.size() + 1);
+  my_codec->encode_batch(raws.size(), raw_bufs.data(), raw_lens.data(),
+                         enc_buf.data(), enc_buf_len, enc_offsets.data());
+
+  // Decode them back into another arena.
+  std::vector<const char *> enc_bufs;
+  std::vector<size_t> enc_lens;
+  size_t dec_buf_len = 0;
+  for (size_t i = 0; i < raws.size(); ++i) {
+    enc_bufs.push_back(enc_buf.data() + enc_offsets[i]);
+    enc_lens.push_back(enc_offsets[i + 1] - enc_offsets[i]);
+    dec_buf_len += my_codec->get_max_decoded_buf_len(enc_lens[i]);
+  }
+  std::vector<char> dec_buf(dec_buf_len);
+  std::vector<size_t> dec_offsets(raws.size() + 1);
+  my_codec->decode_batch(raws.size(), enc_bufs.data(), enc_lens.data(),
+                         dec_buf.data(), dec_buf_len, dec_offsets.data());
+
+  for (size_t i = 0; i < raws.size(); ++i) {
+    std::cout << test_name << " batch item " << i << " encoded: "
+              << std::string(enc_bufs[i], enc_lens[i]) << " decoded: "
+              << std::string(dec_buf.data() + dec_offsets[i],
+                             dec_offsets[i + 1] - dec_offsets[i])
+              << std::endl;
+  }
+}
+
+void codec_strict_test(const std::string &enc,
+                       cryptcpp::codec::codec_algorithm codec_algo,
+                       const std::string &test_name) {
+  std::cout << std::endl
+            << "____________________________________________________"
+            << std::endl;
+  auto fact = cryptcpp::factory::get_factory();
+  std::shared_ptr<cryptcpp::codec> my_codec(fact->create_codec(codec_algo));
+
+  // Malformed input is reported with its position, without exceptions.
+  std::vector<char> dec_buf(my_codec->get_max_decoded_buf_len(enc.size()));
+  cryptcpp::codec::decode_error error;
+  size_t error_offset;
+  const ssize_t dec_len =
+      my_codec->decode_strict(enc.c_str(), enc.size(), dec_buf.data(),
+                              dec_buf.size(), error, error_offset);
+  std::cout << test_name << " strict decoding of \"" << enc << "\": ";
+  if (dec_len < 0) {
+    std::cout << cryptcpp::codec::get_decode_error_string(error)
+              << " at offset " << error_offset << std::endl;
+  } else {
+    std::cout << std::string(dec_buf.data(), dec_len) << std::endl;
+  }
+}
+
+// The encoding of raw as EVP_EncodeBlock() or a plain loop writes it.
+std::string reference_encoding(const std::string &raw,
+                               cryptcpp::codec::codec_algorithm codec_algo) {
+  std::string enc;
+  if (codec_algo == cryptcpp::codec::CODEC_HEX) {
+    static const char digits[] = "0123456789ABCDEF";
+    for (size_t i = 0; i < raw.size(); ++i) {
+      enc += digits[static_cast<unsigned char>(raw[i]) >> 4];
+      enc += digits[static_cast<unsigned char>(raw[i]) & 0xf];
+    }
+    return enc;
+  }
+
+  std::vector<unsigned char> buf((raw.size() + 2) / 3 * 4 + 1);
+  const int len = EVP_EncodeBlock(
+      buf.data(), reinterpret_cast<const unsigned char *>(raw.data()),
+      static_cast<int>(raw.size()));
+  if (codec_algo != cryptcpp::codec::CODEC_BASE64_NL) {
+    return std::string(buf.begin(), buf.begin() + len);
+  }
+  for (int pos = 0; pos < len; pos += 64) {
+    enc.append(buf.begin() + pos, buf.begin() + std::min(pos + 64, len));
+    enc += '\n';
+  }
+  return enc;
+}
+
+bool codec_threads_test(const std::string &raw,
+                        cryptcpp::codec::codec_algorithm codec_algo,
+                        const std::string &test_name, size_t num_threads) {
+  std::cout << std::endl
+            << "____________________________________________________"
+            << std::endl;
+  auto fact = cryptcpp::factory::get_factory();
+  std::shared_ptr<cryptcpp::codec> my_codec(fact->create_codec(codec_algo));
+  const std::string ref = reference_encoding(raw, codec_algo);
+
+  // A large buffer split over threads encodes and decodes byte for byte
+  // as on one thread.
+  bool same = true;
+  const size_t threads[] = {1, num_threads};
+  for (size_t i = 0; i < 2; ++i) {
+    my_codec->set_num_threads(threads[i]);
+    std::vector<char> enc(my_codec->get_max_encoded_buf_len(raw.size()));
+    enc.resize(my_codec->encode(raw.c_str(), raw.size(), enc.data(),
+                                enc.size()));
+    std::vector<char> dec(my_codec->get_max_decoded_buf_len(enc.size()));
+    dec.resize(
+        my_codec->decode(enc.data(), enc.size(), dec.data(), dec.size()));
+    same = same && std::string(enc.begin(), enc.end()) == ref &&
+           std::string(dec.begin(), dec.end()) == raw;
+  }
+  std::cout << test_name << " of " << raw.size() << " bytes on "
+            << num_threads << " threads: "
+            << (same ? "same as on one thread" : "MISMATCH") << std::endl;
+  return same;
+}
+
+#if __cplusplus >= 201703L
+void codec_literal_test() {
+  std::cout << std::endl
+            << "____________________________________________________"
+            << std::endl;
+  // Decoded by the compiler; nothing runs at startup.
+  constexpr auto salt = CRYPTCPP_HEX_LITERAL("4120717569636b");
+  constexpr auto word = CRYPTCPP_BASE64_LITERAL("QSBxdWljaw==");
+  static_assert(salt.size() == word.size() && salt[6] == word[6],
+                "Literals decode alike");
+  // Base-64 URL literals carry no padding.
+  constexpr auto url = CRYPTCPP_BASE64URL_LITERAL("QSBxdWljaw");
+  static_assert(url.size() == word.size() && url[6] == word[6],
+                "Literals decode alike");
+
+  constexpr auto enc = cryptcpp::codec_literal::base64_encode(salt);
+  std::cout << "Compile time decoded data: "
+            << std::string(salt.begin(), salt.end())
+            << " re-encoded: " << enc.data() << std::endl;
+}
+#endif
+
 int main() {
   std::string raw = "A quick brown fox jumped over a lazy dog!";
   codec_test(raw, cryptcpp::codec::CODEC_BASE64, "BASE64");
   codec_test(raw, cryptcpp::codec::CODEC_BASE64_NL, "BASE64_NL");
   codec_test(raw, cryptcpp::codec::CODEC_HEX, "HEX");
+  codec_test(raw, cryptcpp::codec::CODEC_HEX_LOWER, "HEX_LOWER");
+  codec_test(raw, cryptcpp::codec::CODEC_BASE64URL, "BASE64URL");
+  codec_test(raw, cryptcpp::codec::CODEC_BASE64_NOPAD, "BASE64_NOPAD");
+  codec_test(raw, cryptcpp::codec::CODEC_BASE32, "BASE32");
+  codec_test(raw, cryptcpp::codec::CODEC_BASE32HEX, "BASE32HEX");
+  codec_test(raw, cryptcpp::codec::CODEC_BASE58, "BASE58");
+
+  // The characters for 62 and 63 differ between the Base-64 alphabets.
+  codec_test("<<?\?\?>>", cryptcpp::codec::CODEC_BASE64, "BASE64");
+  codec_test("<<?\?\?>>", cryptcpp::codec::CODEC_BASE64URL, "BASE64URL");
+
+  // Leading zero bytes survive the round trip.
+  codec_test(std::string("\0\0zero", 6), cryptcpp::codec::CODEC_HEX, "HEX");
+  codec_test(std::string("\0\0zero", 6), cryptcpp::codec::CODEC_BASE58,
+             "BASE58");
+
+  // Every codec rejects malformed input alike.
+  codec_error_test("4120G1", cryptcpp::codec::CODEC_HEX, "HEX");
+  codec_error_test("41207", cryptcpp::codec::CODEC_HEX, "HEX");
+  codec_error_test("QSBx*Wlj", cryptcpp::codec::CODEC_BASE64, "BASE64");
+  codec_error_test("QSBxd", cryptcpp::codec::CODEC_BASE64, "BASE64");
+  codec_error_test("MFRGG1==", cryptcpp::codec::CODEC_BASE32, "BASE32");
+  codec_error_test("3yQ0l", cryptcpp::codec::CODEC_BASE58, "BASE58");
+
+  // Chunks that split encoding groups and lines.
+  codec_stream_test(raw + raw, cryptcpp::codec::CODEC_BASE64_NL, "BASE64_NL",
+                    7);
+  codec_stream_test(raw, cryptcpp::codec::CODEC_HEX, "HEX", 5);
+  // Unpadded groups may complete with held back bytes in a one byte chunk.
+  codec_stream_test(raw, cryptcpp::codec::CODEC_BASE64URL, "BASE64URL", 1);
+  codec_stream_test(raw, cryptcpp::codec::CODEC_BASE32, "BASE32", 3);
+
+  codec_in_place_test(raw, cryptcpp::codec::CODEC_BASE64_NL, "BASE64_NL");
+  codec_in_place_test(raw, cryptcpp::codec::CODEC_HEX, "HEX");
+
+  codec_strict_test("QSBxdWljaw==", cryptcpp::codec::CODEC_BASE64, "BASE64");
+  codec_strict_test("QSBxd*ljaw==", cryptcpp::codec::CODEC_BASE64, "BASE64");
+  codec_strict_test("QSBxdWljaw", cryptcpp::codec::CODEC_BASE64, "BASE64");
+  codec_strict_test("QSBxdWljax==", cryptcpp::codec::CODEC_BASE64, "BASE64");
+  codec_strict_test("QSBxdWljaw==", cryptcpp::codec::CODEC_BASE64URL,
+                    "BASE64URL");
+  codec_strict_test("QUJD\n", cryptcpp::codec::CODEC_BASE64_NL, "BASE64_NL");
+  codec_strict_test("QU\nJD", cryptcpp::codec::CODEC_BASE64_NL, "BASE64_NL");
+  codec_strict_test("ieqhc5ljmnvq====", cryptcpp::codec::CODEC_BASE32,
+                    "BASE32");
+  codec_strict_test("IEQHC5LJMNVR====", cryptcpp::codec::CODEC_BASE32,
+                    "BASE32");
+  codec_strict_test("3Dd7tSg6oW0", cryptcpp::codec::CODEC_BASE58, "BASE58");
+  codec_strict_test("4120717569636B", cryptcpp::codec::CODEC_HEX, "HEX");
+  codec_strict_test("4120717569G36B", cryptcpp::codec::CODEC_HEX, "HEX");
+
+#if __cplusplus >= 201703L
+  codec_literal_test();
+#endif
+
+  // Many small buffers in one call.
+  std::vector<std::string> raws = {"A quick", "brown fox", "", "jumped"};
+  codec_batch_test(raws, cryptcpp::codec::CODEC_BASE64, "BASE64");
+  codec_batch_test(raws, cryptcpp::codec::CODEC_HEX, "HEX");
+
+  // Large buffers split over threads, in pieces that do not line up with
+  // groups or lines.
+  std::string large(3 * 1024 * 1024 + 17, '\0');
+  for (size_t i = 0; i < large.size(); ++i) {
+    large[i] = static_cast<char>((i * 131 + (i >> 9)) & 0xff);
+  }
+  bool threads_ok = true;
+  const size_t thread_counts[] = {4, 7};
+  for (size_t i = 0; i < 2; ++i) {
+    threads_ok = codec_threads_test(large, cryptcpp::codec::CODEC_BASE64,
+                                    "BASE64", thread_counts[i]) &&
+                 threads_ok;
+    threads_ok = codec_threads_test(large, cryptcpp::codec::CODEC_BASE64_NL,
+                                    "BASE64_NL", thread_counts[i]) &&
+                 threads_ok;
+    threads_ok = codec_threads_test(large, cryptcpp::codec::CODEC_HEX, "HEX",
+                                    thread_counts[i]) &&
+                 threads_ok;
+  }
 
-  return 0;
+  return (threads_ok ? 0 : 1);
 }
@@ -0,0 +1,306 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include "example_util.hpp"
+#include <cryptcpp/factory.hpp>
+#include <openssl/evp.h>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <unistd.h>
+
+// The digest of data as plain EVP calculates it.
+bytes evp_digest(const char *algo, const unsigned char *data, size_t len) {
+  const EVP_MD *md = EVP_get_digestbyname(algo);
+  bytes dig(EVP_MAX_MD_SIZE);
+  unsigned int dig_len = 0;
+  EVP_Digest(data, len, dig.data(), &dig_len, md, nullptr);
+  dig.resize(dig_len);
+  return dig;
+}
+
+bytes calculate(cryptcpp::digest &dig, const bytes &data) {
+  bytes out(dig.get_digest_len());
+  out.resize(dig.calculate_digest(data.data(), data.size(), out.data(),
+                                  out.size()));
+  return out;
+}
+
+void digest_test(const char *algo) {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::digest> dig(fact->create_digest());
+  dig->set_digest_algorithm(algo);
+  const std::string name(algo);
+
+  const bytes data = test_data(100000, 1);
+  const bytes ref = evp_digest(algo, data.data(), data.size());
+  check(calculate(*dig, data) == ref, name + " one-shot equals EVP");
+
+  // Chunks that do not line up with the blocks.
+  bytes out(dig->get_digest_len());
+  dig->init();
+  for (size_t pos = 0; pos < data.size(); pos += 777) {
+    dig->update(data.data() + pos, std::min<size_t>(777, data.size() - pos));
+  }
+  dig->final(out.data(), out.size());
+  check(out == ref, name + " incremental equals EVP");
+
+  // The same data scattered over a header, a body and a trailer.
+  const cryptcpp::digest::data_segment segments[] = {
+      {data.data(), 13},
+      {data.data() + 13, 65000},
+      {data.data() + 65013, data.size() - 65013}};
+  dig->calculate_digest(segments, 3, out.data(), out.size());
+  check(out == ref, name + " scatter-gather equals EVP");
+
+  check(calculate(*dig, bytes()) == evp_digest(algo, nullptr, 0),
+        name + " of no data equals EVP");
+}
+
+void digest_batch_test(const char *algo) {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::digest> dig(fact->create_digest());
+  dig->set_digest_algorithm(algo);
+  const size_t dig_len = dig->get_digest_len();
+
+  // Up to more messages than any multi-buffer engine has lanes, of
+  // lengths around the block boundaries.
+  const size_t counts[] = {1, 3, 8, 16, 37};
+  for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+    const size_t count = counts[c];
+    std::vector<bytes> msgs;
+    std::vector<const unsigned char *> data;
+    std::vector<size_t> lens;
+    for (size_t i = 0; i < count; ++i) {
+      msgs.push_back(test_data((i * 61) % 300, i));
+    }
+    for (size_t i = 0; i < count; ++i) {
+      data.push_back(msgs[i].data());
+      lens.push_back(msgs[i].size());
+    }
+
+    bytes out(count * dig_len);
+    dig->calculate_digest_batch(count, data.data(), lens.data(), out.data(),
+                                out.size());
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) {
+      ok = ok && bytes(out.begin() + i * dig_len,
+                       out.begin() + (i + 1) * dig_len) ==
+                     evp_digest(algo, msgs[i].data(), msgs[i].size());
+    }
+    check(ok, std::string(algo) + " batch of " + std::to_string(count) +
+                  " equals EVP");
+  }
+}
+
+// The Merkle tree hash of RFC 6962 over 1 MiB chunks, from its definition.
+bytes tree_reference(const unsigned char *data, size_t len) {
+  const size_t chunk = 1024 * 1024;
+  if (len <= chunk) {
+    bytes leaf(1, 0x00);
+    leaf.insert(leaf.end(), data, data + len);
+    return len ? evp_digest("SHA256", leaf.data(), leaf.size())
+               : evp_digest("SHA256", nullptr, 0);
+  }
+
+  const size_t num_chunks = (len + chunk - 1) / chunk;
+  size_t left = 1;
+  while (2 * left < num_chunks) {
+    left *= 2;
+  }
+  const bytes l = tree_reference(data, left * chunk);
+  const bytes r = tree_reference(data + left * chunk, len - left * chunk);
+  bytes node(1, 0x01);
+  node.insert(node.end(), l.begin(), l.end());
+  node.insert(node.end(), r.begin(), r.end());
+  return evp_digest("SHA256", node.data(), node.size());
+}
+
+void tree_digest_test() {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::digest> dig(fact->create_digest());
+  dig->set_digest_algorithm(cryptcpp::digest::DIGEST_TREE_SHA256());
+
+  const size_t lens[] = {0, 1000, 1024 * 1024, 5 * 1024 * 1024 + 3};
+  for (size_t threads = 1; threads <= 4; threads += 3) {
+    dig->set_num_threads(threads);
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); ++i) {
+      const bytes data = test_data(lens[i], 3);
+      const bytes ref = tree_reference(data.data(), data.size());
+      check(calculate(*dig, data) == ref,
+            "TREE-SHA256 of " + std::to_string(lens[i]) + " bytes on " +
+                std::to_string(threads) + " threads equals RFC 6962");
+    }
+  }
+}
+
+void file_digest_test() {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::digest> dig(fact->create_digest());
+  dig->set_digest_algorithm(cryptcpp::digest::DIGEST_SHA256());
+
+  char path[] = "/tmp/cryptcpp_digest_test_XXXXXX";
+  const int fd = mkstemp(path);
+  const bytes data = test_data(3 * 1024 * 1024 + 5, 2);
+  const bool written =
+      fd >= 0 && write(fd, data.data(), data.size()) ==
+                     static_cast<ssize_t>(data.size());
+  if (fd >= 0)
+    close(fd);
+
+  bytes out(dig->get_digest_len());
+  if (written) {
+    dig->calculate_file_digest(path, out.data(), out.size());
+  }
+  unlink(path);
+  check(written && out == evp_digest("SHA256", data.data(), data.size()),
+        "SHA256 file digest equals EVP");
+}
+
+void copy_state_test() {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::digest> prefix(fact->create_digest());
+  prefix->set_digest_algorithm(cryptcpp::digest::DIGEST_SHA512());
+
+  const bytes salt = test_data(150, 4);
+  const std::string msgs[] = {"first message", "second message"};
+  prefix->init();
+  prefix->update(salt.data(), salt.size());
+
+  std::unique_ptr<cryptcpp::digest> dig(fact->create_digest());
+  for (size_t i = 0; i < 2; ++i) {
+    bytes whole(salt);
+    whole.insert(whole.end(), msgs[i].begin(), msgs[i].end());
+    const bytes ref = evp_digest("SHA512", whole.data(), whole.size());
+
+    bytes out(prefix->get_digest_len());
+    dig->copy_state(*prefix);
+    dig->update(reinterpret_cast<const unsigned char *>(msgs[i].data()),
+                msgs[i].size());
+    dig->final(out.data(), out.size());
+    check(out == ref, "SHA512 copied state, message " + std::to_string(i));
+
+    std::unique_ptr<cryptcpp::digest> clone(prefix->clone_state());
+    clone->update(reinterpret_cast<const unsigned char *>(msgs[i].data()),
+                  msgs[i].size());
+    clone->final(out.data(), out.size());
+    check(out == ref, "SHA512 cloned state, message " + std::to_string(i));
+  }
+}
+
+void export_state_test(const char *algo) {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::digest> dig(fact->create_digest());
+  dig->set_digest_algorithm(algo);
+  const bytes data = test_data(1000, 5);
+  const bytes ref = evp_digest(algo, data.data(), data.size());
+
+  // Not exportable unless asked for before init().
+  unsigned char state[cryptcpp::digest::DIGEST_STATE_MAX_LEN()];
+  dig->init();
+  bool exported = true;
+  try {
+    exported = dig->export_state(state, sizeof(state));
+  } catch (const std::exception &) {
+    exported = false;
+  }
+  check(!exported, std::string(algo) + " not exportable by default");
+
+  // Split mid block, at a block boundary and at the end.
+  dig->set_exportable(true);
+  const size_t splits[] = {0, 1, 64, 127, 128, 500, 1000};
+  bool ok = true;
+  for (size_t i = 0; i < sizeof(splits) / sizeof(splits[0]); ++i) {
+    dig->init();
+    dig->update(data.data(), splits[i]);
+    const size_t state_len = dig->export_state(state, sizeof(state));
+
+    std::unique_ptr<cryptcpp::digest> resumed(fact->create_digest());
+    resumed->import_state(state, state_len);
+    resumed->update(data.data() + splits[i], data.size() - splits[i]);
+    bytes out(resumed->get_digest_len());
+    resumed->final(out.data(), out.size());
+    ok = ok && out == ref;
+  }
+  check(ok, std::string(algo) + " exported and imported states");
+}
+
+void multi_digest_test() {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::multi_digest> multi(fact->create_multi_digest());
+  const cryptcpp::digest::digest_algorithm algos[] = {
+      cryptcpp::digest::DIGEST_MD5(), cryptcpp::digest::DIGEST_SHA256(),
+      cryptcpp::digest::DIGEST_SHA3_512()};
+  multi->set_digest_algorithms(algos, 3);
+
+  const bytes data = test_data(70000, 6);
+  bytes out(multi->get_digests_len());
+  multi->calculate_digests(data.data(), data.size(), out.data(), out.size());
+
+  bytes ref;
+  for (size_t i = 0; i < 3; ++i) {
+    const bytes dig = evp_digest(algos[i], data.data(), data.size());
+    ref.insert(ref.end(), dig.begin(), dig.end());
+  }
+  check(out == ref, "MD5, SHA256 and SHA3-512 in one pass equal EVP");
+}
+
+void xof_test() {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::digest> dig(fact->create_digest());
+  dig->set_digest_algorithm(cryptcpp::digest::DIGEST_SHAKE256());
+  const bytes data = test_data(1000, 7);
+
+  // Any output length may be squeezed out.
+  bytes out(100);
+  const size_t out_len =
+      dig->calculate_digest(data.data(), data.size(), out.data(), out.size());
+
+  bytes ref(100);
+  EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+  EVP_DigestInit_ex(ctx, EVP_shake256(), nullptr);
+  EVP_DigestUpdate(ctx, data.data(), data.size());
+  EVP_DigestFinalXOF(ctx, ref.data(), ref.size());
+  EVP_MD_CTX_free(ctx);
+  check(out_len == 100 && out == ref, "SHAKE256 of 100 bytes equals EVP");
+}
+
+int main() {
+  const char *algos[] = {"MD5",      "SHA1",       "SHA256",
+                         "SHA512",   "SHA3-256",   "BLAKE2b512"};
+  for (size_t i = 0; i < sizeof(algos) / sizeof(algos[0]); ++i) {
+    digest_test(algos[i]);
+  }
+  file_digest_test();
+
+  digest_batch_test("SHA1");
+  digest_batch_test("SHA256");
+  digest_batch_test("SHA512");
+
+  tree_digest_test();
+  copy_state_test();
+
+  export_state_test("SHA1");
+  export_state_test("SHA224");
+  export_state_test("SHA256");
+  export_state_test("SHA384");
+  export_state_test("SHA512");
+
+  multi_digest_test();
+  xof_test();
+
+  return (failures ? 1 : 0);
+}
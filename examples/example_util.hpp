@@ -0,0 +1,50 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_EXAMPLE_UTIL_HPP__
+#define __CRYPTCPP_EXAMPLE_UTIL_HPP__
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+//@{
+// Helpers shared by the examples that check their results against plain
+// OpenSSL. Each check prints OK or FAILED; the example exits non-zero if
+// any check failed.
+//@}
+
+typedef std::vector<unsigned char> bytes;
+
+static int failures = 0;
+
+inline void check(bool ok, const std::string &what) {
+  std::cout << what << ": " << (ok ? "OK" : "FAILED") << std::endl;
+  if (!ok) {
+    ++failures;
+  }
+}
+
+inline void separator() {
+  std::cout << std::endl
+            << "____________________________________________________"
+            << std::endl;
+}
+
+// Deterministic data that differs per seed and does not repeat every
+// 256 bytes.
+inline bytes test_data(size_t len, unsigned int seed) {
+  bytes data(len);
+  for (size_t i = 0; i < len; ++i) {
+    data[i] = static_cast<unsigned char>((i * 131 + seed * 7 + (i >> 9)) &
+                                         0xff);
+  }
+  return data;
+}
+
+#endif
@@ -0,0 +1,183 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include "example_util.hpp"
+#include <cryptcpp/factory.hpp>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <algorithm>
+#include <memory>
+
+// The MAC of data as plain EVP_MAC calculates it.
+bytes evp_mac(const char *algo, const bytes &key, const bytes &data) {
+  EVP_MAC *mac = EVP_MAC_fetch(nullptr, algo, nullptr);
+  EVP_MAC_CTX *ctx = EVP_MAC_CTX_new(mac);
+  bytes out(64);
+  size_t out_len = 0;
+  EVP_MAC_init(ctx, key.data(), key.size(), nullptr);
+  EVP_MAC_update(ctx, data.data(), data.size());
+  EVP_MAC_final(ctx, out.data(), &out_len, out.size());
+  EVP_MAC_CTX_free(ctx);
+  EVP_MAC_free(mac);
+  out.resize(out_len);
+  return out;
+}
+
+bytes calculate(cryptcpp::mac &m, const bytes &data) {
+  bytes out(m.get_mac_len());
+  out.resize(m.calculate_mac(data.data(), data.size(), out.data(),
+                             out.size()));
+  return out;
+}
+
+void hmac_test(const char *digest_algo) {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::mac> m(fact->create_mac());
+  const std::string name = std::string("HMAC-") + digest_algo;
+  m->set_mac_algorithm(name.c_str());
+  const EVP_MD *md = EVP_get_digestbyname(digest_algo);
+
+  // Keys shorter and longer than a block, the latter hashed first.
+  const size_t key_lens[] = {16, 200};
+  for (size_t k = 0; k < 2; ++k) {
+    const bytes key = test_data(key_lens[k], 1);
+    m->set_key(key.data(), key.size());
+
+    // Every calculation restarts from the keyed state.
+    bool ok = true;
+    for (size_t len = 0; len < 300; len += 73) {
+      const bytes data = test_data(len, 2);
+      bytes ref(EVP_MAX_MD_SIZE);
+      unsigned int ref_len = 0;
+      HMAC(md, key.data(), key.size(), data.data(), data.size(), ref.data(),
+           &ref_len);
+      ref.resize(ref_len);
+      ok = ok && calculate(*m, data) == ref;
+    }
+    check(ok, name + " with a " + std::to_string(key.size()) +
+                  " byte key equals HMAC()");
+  }
+
+  // Incremental calculation of the same data.
+  const bytes data = test_data(1000, 3);
+  bytes out(m->get_mac_len());
+  m->init();
+  for (size_t pos = 0; pos < data.size(); pos += 99) {
+    m->update(data.data() + pos, std::min<size_t>(99, data.size() - pos));
+  }
+  m->final(out.data(), out.size());
+  check(out == calculate(*m, data), name + " incremental equals one-shot");
+}
+
+void kmac_test(const char *algo) {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::mac> m(fact->create_mac());
+  m->set_mac_algorithm(algo);
+
+  const bytes key = test_data(32, 4);
+  const bytes data = test_data(500, 5);
+  m->set_key(key.data(), key.size());
+  check(calculate(*m, data) == evp_mac(algo, key, data),
+        std::string(algo) + " equals EVP_MAC");
+
+  // A new key replaces the old one.
+  const bytes key2 = test_data(32, 6);
+  m->set_key(key2.data(), key2.size());
+  check(calculate(*m, data) == evp_mac(algo, key2, data),
+        std::string(algo) + " after re-keying equals EVP_MAC");
+}
+
+void mac_batch_test() {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::mac> m(fact->create_mac());
+  m->set_mac_algorithm(cryptcpp::mac::MAC_HMAC_SHA256());
+  const bytes key = test_data(32, 7);
+  m->set_key(key.data(), key.size());
+  const size_t mac_len = m->get_mac_len();
+
+  std::vector<bytes> msgs;
+  std::vector<const unsigned char *> data;
+  std::vector<size_t> lens;
+  for (size_t i = 0; i < 20; ++i) {
+    msgs.push_back(test_data(i * 17, i));
+  }
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    data.push_back(msgs[i].data());
+    lens.push_back(msgs[i].size());
+  }
+
+  bytes out(msgs.size() * mac_len);
+  m->calculate_mac_batch(msgs.size(), data.data(), lens.data(), out.data(),
+                         out.size());
+  bool ok = true;
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    const bytes mac_i(out.begin() + i * mac_len,
+                      out.begin() + (i + 1) * mac_len);
+    ok = ok && mac_i == calculate(*m, msgs[i]);
+  }
+  check(ok, "HMAC-SHA256 batch of 20 equals one by one");
+}
+
+void poly1305_test() {
+  separator();
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::mac> m(fact->create_mac());
+  m->set_mac_algorithm(cryptcpp::mac::MAC_POLY1305());
+
+  const bytes key = test_data(32, 8);
+  const bytes data = test_data(100, 9);
+  m->set_key(key.data(), key.size());
+  check(calculate(*m, data) == evp_mac("POLY1305", key, data),
+        "POLY1305 equals EVP_MAC");
+
+  // The key of a one-time authenticator serves a single message.
+  bool reused = true;
+  try {
+    reused = !calculate(*m, data).empty();
+  } catch (const std::exception &e) {
+    std::cout << e.what() << std::endl;
+    reused = false;
+  }
+  check(!reused, "POLY1305 key not reused");
+
+  m->set_key(key.data(), key.size());
+  check(calculate(*m, data) == evp_mac("POLY1305", key, data),
+        "POLY1305 after re-keying equals EVP_MAC");
+
+  // Nor does it serve a batch.
+  const unsigned char *msgs[] = {data.data(), data.data()};
+  const size_t lens[] = {data.size(), data.size()};
+  bytes out(2 * m->get_mac_len());
+  m->set_key(key.data(), key.size());
+  bool batched = true;
+  try {
+    batched = m->calculate_mac_batch(2, msgs, lens, out.data(), out.size());
+  } catch (const std::exception &e) {
+    std::cout << e.what() << std::endl;
+    batched = false;
+  }
+  check(!batched, "POLY1305 batch rejected");
+}
+
+int main() {
+  hmac_test("SHA1");
+  hmac_test("SHA256");
+  hmac_test("SHA512");
+  hmac_test("SHA3-256");
+
+  kmac_test(cryptcpp::mac::MAC_KMAC128());
+  kmac_test(cryptcpp::mac::MAC_KMAC256());
+
+  mac_batch_test();
+  poly1305_test();
+
+  return (failures ? 1 : 0);
+}
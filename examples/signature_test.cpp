@@ -0,0 +1,263 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include "example_util.hpp"
+#include <cryptcpp/factory.hpp>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <unistd.h>
+
+// A freshly generated key pair in temporary PEM files, removed with it.
+struct key_pair {
+  explicit key_pair(EVP_PKEY *pkey) {
+    priv = write_pem(pkey, true);
+    pub = write_pem(pkey, false);
+    EVP_PKEY_free(pkey);
+  }
+
+  ~key_pair() {
+    unlink(priv.c_str());
+    unlink(pub.c_str());
+  }
+
+  static std::string write_pem(EVP_PKEY *pkey, bool private_key) {
+    char path[] = "/tmp/cryptcpp_signature_test_XXXXXX";
+    FILE *fp = fdopen(mkstemp(path), "w");
+    if (fp) {
+      if (private_key)
+        PEM_write_PrivateKey(fp, pkey, nullptr, nullptr, 0, nullptr,
+                             nullptr);
+      else
+        PEM_write_PUBKEY(fp, pkey);
+      fclose(fp);
+    }
+    return path;
+  }
+
+  std::string priv;
+  std::string pub;
+};
+
+std::unique_ptr<cryptcpp::digital_signature>
+make_signature(const key_pair &keys, bool for_sign,
+               cryptcpp::digest::digest_algorithm digest_algo) {
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::digital_signature> sig(
+      fact->create_digital_signature());
+  if (for_sign) {
+    sig->set_key(keys.priv.c_str(),
+                 cryptcpp::asymmetric_key::ASYM_KEY_PRIVATE, nullptr, 0);
+  } else {
+    sig->set_key(keys.pub.c_str(), cryptcpp::asymmetric_key::ASYM_KEY_PUBLIC,
+                 nullptr, 0);
+  }
+  sig->set_digest_algo(digest_algo);
+  return sig;
+}
+
+bytes sign(cryptcpp::digital_signature &signer, const bytes &data) {
+  bytes sig(1024);
+  sig.resize(signer.sign(data.data(), data.size(), sig.data(), sig.size()));
+  return sig;
+}
+
+bool verify(cryptcpp::digital_signature &verifier, const bytes &data,
+            const bytes &sig) {
+  return verifier.verify(data.data(), data.size(), sig.data(), sig.size());
+}
+
+void sign_equivalence_test(const key_pair &keys, const std::string &key_name,
+                           const char *digest_algo, bool deterministic) {
+  separator();
+  const std::string name = key_name + " " + digest_algo;
+  auto signer = make_signature(keys, true, digest_algo);
+  auto verifier = make_signature(keys, false, digest_algo);
+  auto fact = cryptcpp::factory::get_factory();
+  std::unique_ptr<cryptcpp::digest> dig(fact->create_digest());
+  dig->set_digest_algorithm(digest_algo);
+
+  const bytes data = test_data(10000, 1);
+  bytes hash(dig->get_digest_len());
+  dig->calculate_digest(data.data(), data.size(), hash.data(), hash.size());
+
+  // The same data signed at once, as a digest and as a stream.
+  bytes sigs[3];
+  sigs[0] = sign(*signer, data);
+  sigs[1].resize(1024);
+  sigs[1].resize(signer->sign_digest(hash.data(), hash.size(),
+                                     sigs[1].data(), sigs[1].size()));
+  sigs[2].resize(1024);
+  signer->sign_init();
+  for (size_t pos = 0; pos < data.size(); pos += 999) {
+    signer->sign_update(data.data() + pos,
+                        std::min<size_t>(999, data.size() - pos));
+  }
+  sigs[2].resize(signer->sign_final(sigs[2].data(), sigs[2].size()));
+
+  // Every signature verifies every way.
+  const char *ways[] = {"sign", "sign_digest", "streaming"};
+  for (size_t i = 0; i < 3; ++i) {
+    bool ok = verify(*verifier, data, sigs[i]) &&
+              verifier->verify_digest(hash.data(), hash.size(),
+                                      sigs[i].data(), sigs[i].size());
+    verifier->verify_init();
+    verifier->verify_update(data.data(), 5000);
+    verifier->verify_update(data.data() + 5000, data.size() - 5000);
+    ok = ok && verifier->verify_final(sigs[i].data(), sigs[i].size());
+    check(ok, name + " " + ways[i] + " signature verifies every way");
+  }
+  if (deterministic) {
+    check(sigs[0] == sigs[1] && sigs[1] == sigs[2],
+          name + " signatures are identical");
+  }
+
+  bytes tampered(data);
+  tampered[5000] ^= 1;
+  check(!verify(*verifier, tampered, sigs[0]), name + " tampered rejected");
+}
+
+void eddsa_test(const key_pair &keys) {
+  separator();
+  auto signer = make_signature(keys, true, "SHA256");
+  auto verifier = make_signature(keys, false, "SHA256");
+  const bytes data = test_data(1000, 3);
+
+  // EdDSA hashes the message itself; the digest algorithm is ignored.
+  const bytes sig = sign(*signer, data);
+  check(sig.size() == 64 && verify(*verifier, data, sig) &&
+            sig == sign(*signer, data),
+        "ED25519 signature verifies");
+
+  bool signed_digest = true;
+  try {
+    bytes digest_sig(1024);
+    signed_digest = signer->sign_digest(data.data(), 32, digest_sig.data(),
+                                        digest_sig.size());
+  } catch (const std::exception &) {
+    signed_digest = false;
+  }
+  check(!signed_digest, "ED25519 does not sign digests");
+}
+
+void verify_batch_test(const key_pair *const *keys, size_t num_keys) {
+  separator();
+  std::vector<std::unique_ptr<cryptcpp::digital_signature>> verifiers;
+  std::vector<bytes> msgs, sigs;
+  for (size_t i = 0; i < 30; ++i) {
+    const key_pair &k = *keys[i % num_keys];
+    auto signer = make_signature(k, true, "SHA256");
+    msgs.push_back(test_data(100 + i, i));
+    sigs.push_back(sign(*signer, msgs[i]));
+    verifiers.push_back(make_signature(k, false, "SHA256"));
+    // Every fourth signature does not match its message.
+    if (i % 4 == 3) {
+      msgs[i][0] ^= 1;
+    }
+  }
+
+  std::vector<const unsigned char *> data, sig_data;
+  std::vector<size_t> data_lens, sig_lens;
+  std::vector<const cryptcpp::digital_signature *> verifier_ptrs;
+  bool expected[30];
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    data.push_back(msgs[i].data());
+    data_lens.push_back(msgs[i].size());
+    sig_data.push_back(sigs[i].data());
+    sig_lens.push_back(sigs[i].size());
+    verifier_ptrs.push_back(verifiers[i].get());
+    expected[i] = verify(*verifiers[i], msgs[i], sigs[i]);
+  }
+
+  for (size_t threads = 1; threads <= 4; threads += 3) {
+    verifiers[0]->set_num_threads(threads);
+    bool results[30];
+    const size_t passed = verifiers[0]->verify_batch(
+        msgs.size(), data.data(), data_lens.data(), sig_data.data(),
+        sig_lens.data(), verifier_ptrs.data(), results);
+    check(passed == static_cast<size_t>(
+                        std::count(expected, expected + 30, true)) &&
+              std::equal(results, results + 30, expected),
+          "Batch of 30 RSA, EC and ED25519 signatures on " +
+              std::to_string(threads) + " threads");
+  }
+}
+
+void invalidation_test(const key_pair &keys, const key_pair &other_keys) {
+  separator();
+  auto signer = make_signature(keys, true, "SHA256");
+  auto verifier = make_signature(keys, false, "SHA256");
+  auto other_verifier = make_signature(other_keys, false, "SHA256");
+  const bytes data = test_data(300, 2);
+
+  // Signing prepares a context for the key and digest algorithm, which
+  // must not outlive either.
+  check(verify(*verifier, data, sign(*signer, data)), "Signed with key");
+  signer->set_key(other_keys.priv.c_str(),
+                  cryptcpp::asymmetric_key::ASYM_KEY_PRIVATE, nullptr, 0);
+  bytes sig = sign(*signer, data);
+  check(verify(*other_verifier, data, sig) && !verify(*verifier, data, sig),
+        "Signed with the new key after set_key");
+
+  signer->set_digest_algo("SHA384");
+  sig = sign(*signer, data);
+  other_verifier->set_digest_algo("SHA256");
+  const bool old_digest = verify(*other_verifier, data, sig);
+  other_verifier->set_digest_algo("SHA384");
+  check(verify(*other_verifier, data, sig) && !old_digest,
+        "Signed with the new digest after set_digest_algo");
+}
+
+void context_reuse_test(const key_pair &keys) {
+  separator();
+  auto signer = make_signature(keys, true, "SHA256");
+  auto verifier = make_signature(keys, false, "SHA256");
+
+  // One-shot calls and streams interleaved on the same objects.
+  bool ok = true;
+  for (unsigned int i = 0; i < 50; ++i) {
+    const bytes data = test_data(i * 37, i);
+    const bytes sig = sign(*signer, data);
+    if (i % 5 == 0) {
+      signer->sign_init();
+      signer->sign_update(data.data(), data.size());
+      bytes stream_sig(1024);
+      stream_sig.resize(
+          signer->sign_final(stream_sig.data(), stream_sig.size()));
+      ok = ok && verify(*verifier, data, stream_sig);
+    }
+    ok = ok && verify(*verifier, data, sig);
+  }
+  check(ok, "EC 50 signatures on reused contexts verify");
+}
+
+int main() {
+  const key_pair rsa(
+      EVP_PKEY_Q_keygen(nullptr, nullptr, "RSA", size_t(2048)));
+  const key_pair rsa2(
+      EVP_PKEY_Q_keygen(nullptr, nullptr, "RSA", size_t(2048)));
+  const key_pair ec(EVP_PKEY_Q_keygen(nullptr, nullptr, "EC", "P-256"));
+  const key_pair ed25519(EVP_PKEY_Q_keygen(nullptr, nullptr, "ED25519"));
+
+  sign_equivalence_test(rsa, "RSA", "SHA256", true);
+  sign_equivalence_test(rsa, "RSA", "SHA512", true);
+  sign_equivalence_test(ec, "EC", "SHA256", false);
+  sign_equivalence_test(ec, "EC", "SHA384", false);
+
+  invalidation_test(rsa, rsa2);
+  context_reuse_test(ec);
+  eddsa_test(ed25519);
+
+  const key_pair *keys[] = {&rsa, &ec, &ed25519};
+  verify_batch_test(keys, 3);
+
+  return (failures ? 1 : 0);
+}
@@ -25,14 +25,60 @@ public:
   //@{
   // Codec Algorithms.
   //@}
-  enum codec_algorithm { CODEC_NONE, CODEC_BASE64, CODEC_BASE64_NL, CODEC_HEX };
+  enum codec_algorithm {
+    CODEC_NONE,
+    CODEC_BASE64,
+    CODEC_BASE64_NL,
+    CODEC_HEX,
+    CODEC_HEX_LOWER,
+    CODEC_BASE64URL,
+    CODEC_BASE64_NOPAD,
+    CODEC_BASE32,
+    CODEC_BASE32HEX,
+    CODEC_BASE58
+  };
+
+  //@{
+  // Errors reported by decode_strict().
+  //@}
+  enum decode_error {
+    DECODE_ERROR_NONE,
+    DECODE_ERROR_CHAR,    // A character outside the alphabet.
+    DECODE_ERROR_PADDING, // Missing, misplaced or non-zero padding.
+    DECODE_ERROR_LENGTH,  // The input ends within a decoding group.
+    DECODE_ERROR_BUFFER   // The output buffer is too short.
+  };
+
+  //@{
+  // @brief Returns a description of a decoding error, for logging.
+  //
+  // @param error the decoding error.
+  // @return the description.
+  //@}
+  static const char *get_decode_error_string(decode_error error) {
+    switch (error) {
+    case DECODE_ERROR_NONE:
+      return "No error";
+    case DECODE_ERROR_CHAR:
+      return "Invalid character";
+    case DECODE_ERROR_PADDING:
+      return "Invalid padding";
+    case DECODE_ERROR_LENGTH:
+      return "Truncated input";
+    case DECODE_ERROR_BUFFER:
+      return "Insufficient buffer length";
+    default:
+      return "Unknown error";
+    }
+  }
 
   //@{
   // @brief Constructor.
   //
   // @param codec_algo codec algorithm.
   //@}
-  explicit codec(codec_algorithm codec_algo) : _M_codec_algo(codec_algo) {}
+  explicit codec(codec_algorithm codec_algo)
+      : _M_codec_algo(codec_algo), _M_num_threads(1) {}
 
   //@{
   // @brief Returns the codec algorithm used.
@@ -41,6 +87,26 @@ public:
   //@}
   codec_algorithm get_algorithm() const { return _M_codec_algo; }
 
+  //@{
+  // @brief Sets the number of threads a large buffer may be split over by
+  // one-shot encode(), and by one-shot decode() for encodings that split
+  // at fixed offsets such as hex. The output is the same as with a single
+  // thread.
+  //
+  // @param num_threads number of threads, 1 (the default) to stay on the
+  // calling thread.
+  //@}
+  void set_num_threads(size_t num_threads) {
+    _M_num_threads = num_threads ? num_threads : 1;
+  }
+
+  //@{
+  // @brief Returns the number of threads a large buffer may be split over.
+  //
+  // @return number of threads.
+  //@}
+  size_t get_num_threads() const { return _M_num_threads; }
+
   //@{
   // @brief Returns maximum size of encoded data for raw data size.
   //
@@ -72,15 +138,153 @@ public:
   //@{
   // @brief Performs decoding.
   //
+  // Every codec reports malformed input, be it an invalid character, bad
+  // padding or a length no encoding has, the way it reports a short output
+  // buffer: through report_exception(). The other decoding calls do the
+  // same.
+  //
+  // dec_buf may be enc_buf to decode in place: the decoded data is never
+  // longer than the encoded data and is written behind the input still to
+  // be read, so an output buffer length of enc_len is enough.
+  //
   // @param enc_buf the input data to be decoded.
   // @param enc_len the length of the input data.
   // @param dec_buf output buffer to write decoded data.
   // @param dec_buf_len the length of the output buffer.
   // @return length of the decoded data, negative on error.
+  // @exception throw on malformed input or insufficient buffer length.
   //@}
   virtual ssize_t decode(const char *enc_buf, size_t enc_len, char *dec_buf,
                          size_t dec_buf_len) = 0;
 
+  //@{
+  // @brief Performs strict decoding. Unlike decode(), input that is not
+  // the exact encoding of some data is rejected: whitespace other than the
+  // line breaks of CODEC_BASE64_NL, padding that is missing where the codec
+  // pads or present where it does not, and non-zero pad bits. Failures,
+  // a short output buffer included, are reported through error and
+  // error_offset rather than as exceptions, and cost no more than decoding
+  // valid input of the same length.
+  //
+  // @param enc_buf the input data to be decoded.
+  // @param enc_len the length of the input data.
+  // @param dec_buf output buffer to write decoded data; may be enc_buf.
+  // @param dec_buf_len the length of the output buffer.
+  // @param error set to the reason of failure, DECODE_ERROR_NONE on
+  // success.
+  // @param error_offset set to the offset in enc_buf of the first invalid
+  // character, or enc_len if the input ends early.
+  // @return length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_strict(const char *enc_buf, size_t enc_len,
+                                char *dec_buf, size_t dec_buf_len,
+                                decode_error &error,
+                                size_t &error_offset) = 0;
+
+  //@{
+  // @brief Encodes a batch of buffers back to back into one output arena.
+  // The encodings are not NUL terminated.
+  //
+  // An arena of the sum of get_max_encoded_buf_len() over all inputs is
+  // always sufficient.
+  //
+  // @param count number of input buffers.
+  // @param raw_bufs the input buffers.
+  // @param raw_lens the lengths of the input buffers.
+  // @param enc_buf output arena to write encoded data.
+  // @param enc_buf_len the length of the output arena.
+  // @param enc_offsets count + 1 entries; entry i is set to the offset of
+  // the encoding of input i in the arena, entry count to the total length.
+  // @return total length of encoded data, negative on error.
+  //@}
+  virtual ssize_t encode_batch(size_t count, const char *const *raw_bufs,
+                               const size_t *raw_lens, char *enc_buf,
+                               size_t enc_buf_len, size_t *enc_offsets) = 0;
+
+  //@{
+  // @brief Decodes a batch of buffers back to back into one output arena.
+  // The batch fails as a whole if any input is malformed.
+  //
+  // An arena of the sum of get_max_decoded_buf_len() over all inputs is
+  // always sufficient.
+  //
+  // @param count number of input buffers.
+  // @param enc_bufs the input buffers.
+  // @param enc_lens the lengths of the input buffers.
+  // @param dec_buf output arena to write decoded data.
+  // @param dec_buf_len the length of the output arena.
+  // @param dec_offsets count + 1 entries; entry i is set to the offset of
+  // the decoding of input i in the arena, entry count to the total length.
+  // @return total length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_batch(size_t count, const char *const *enc_bufs,
+                               const size_t *enc_lens, char *dec_buf,
+                               size_t dec_buf_len, size_t *dec_offsets) = 0;
+
+  //@{
+  // @brief Encodes the next chunk of a stream. Input that does not fill
+  // a whole encoding group is held back until the next call, so the
+  // concatenated output of all updates and encode_final() equals the
+  // one-shot encoding of the concatenated input.
+  //
+  // An output buffer of get_max_encoded_buf_len(raw_len) bytes is
+  // always sufficient. The output is not NUL terminated. Codecs whose
+  // every digit depends on the whole input, such as CODEC_BASE58, do not
+  // support streaming and fail all the streaming calls.
+  //
+  // @param raw_buf the next chunk of the input data.
+  // @param raw_len the length of the chunk.
+  // @param enc_buf output buffer to write encoded data.
+  // @param enc_buf_len the length of the output buffer.
+  // @return length of encoded data, negative on error.
+  //@}
+  virtual ssize_t encode_update(const char *raw_buf, size_t raw_len,
+                                char *enc_buf, size_t enc_buf_len) = 0;
+
+  //@{
+  // @brief Ends an encoding stream, flushing held back input. The codec
+  // is ready for a new stream afterwards.
+  //
+  // An output buffer of get_max_encoded_buf_len(1) bytes is always
+  // sufficient. The output is not NUL terminated.
+  //
+  // @param enc_buf output buffer to write encoded data.
+  // @param enc_buf_len the length of the output buffer.
+  // @return length of encoded data, negative on error.
+  //@}
+  virtual ssize_t encode_final(char *enc_buf, size_t enc_buf_len) = 0;
+
+  //@{
+  // @brief Decodes the next chunk of a stream. Input that does not fill
+  // a whole decoding group is held back until the next call.
+  //
+  // An output buffer of get_max_decoded_buf_len(enc_len + 8) bytes is
+  // always sufficient. Held back input completes early in the chunk, so
+  // unlike decode(), dec_buf must not overlap enc_buf. On error the stream
+  // is discarded.
+  //
+  // @param enc_buf the next chunk of the input data.
+  // @param enc_len the length of the chunk.
+  // @param dec_buf output buffer to write decoded data.
+  // @param dec_buf_len the length of the output buffer.
+  // @return length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_update(const char *enc_buf, size_t enc_len,
+                                char *dec_buf, size_t dec_buf_len) = 0;
+
+  //@{
+  // @brief Ends a decoding stream, flushing held back input. The codec
+  // is ready for a new stream afterwards.
+  //
+  // An output buffer of get_max_decoded_buf_len(8) bytes is always
+  // sufficient.
+  //
+  // @param dec_buf output buffer to write decoded data.
+  // @param dec_buf_len the length of the output buffer.
+  // @return length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_final(char *dec_buf, size_t dec_buf_len) = 0;
+
   //@{
   // @brief Polymorphic base class.
   //@}
@@ -91,6 +295,11 @@ protected:
   // @brief Codec algorithm.
   //@}
   const codec_algorithm _M_codec_algo;
+
+  //@{
+  // @brief Number of threads a large buffer may be split over.
+  //@}
+  size_t _M_num_threads;
 };
 
 } // namespace cryptcpp
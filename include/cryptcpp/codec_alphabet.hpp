@@ -0,0 +1,61 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_CODEC_ALPHABET_HPP__
+#define __CRYPTCPP_CODEC_ALPHABET_HPP__
+
+namespace cryptcpp {
+
+//@{
+// @namespace codec_alphabet
+// @brief The digit alphabets of the codecs, shared by the runtime codecs
+// and the compile time codec_literal functions. Digit i of an encoding is
+// character i of its alphabet.
+//@}
+
+namespace codec_alphabet {
+
+//@{
+// @brief Hex digits.
+//@}
+static const char hex_upper[] = "0123456789ABCDEF";
+static const char hex_lower[] = "0123456789abcdef";
+
+//@{
+// @brief The standard Base-64 alphabet of RFC 4648 section 4.
+//@}
+static const char base64_std[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+//@{
+// @brief The URL and filename safe Base-64 alphabet of RFC 4648 section 5.
+//@}
+static const char base64_url[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+//@{
+// @brief The Base-32 alphabet of RFC 4648 section 6.
+//@}
+static const char base32_std[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+//@{
+// @brief The extended hex Base-32 alphabet of RFC 4648 section 7, which
+// preserves the sort order of the encoded data.
+//@}
+static const char base32_hex[] = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+
+//@{
+// @brief The Bitcoin Base-58 alphabet, without 0, O, I and l.
+//@}
+static const char base58[] =
+    "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+} // namespace codec_alphabet
+
+} // namespace cryptcpp
+#endif
@@ -0,0 +1,261 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_CODEC_LITERAL_HPP__
+#define __CRYPTCPP_CODEC_LITERAL_HPP__
+
+#include "codec_alphabet.hpp"
+#include "cryptcpp_cpp_std.hpp"
+
+#if __cplusplus >= 201703L // C++17 or Higher
+
+#include <array>
+#include <stdexcept>
+
+namespace cryptcpp {
+
+//@{
+// @namespace codec_literal
+// @brief Header only, compile time Hex and Base-64 encoding and decoding
+// of embedded constants such as public keys, test vectors and salts, with
+// the alphabets of the runtime codecs. Requires C++17.
+//
+// The CRYPTCPP_*_LITERAL macros decode a string literal into a
+// std::array<unsigned char, N> during compilation:
+//
+//   constexpr auto salt = CRYPTCPP_HEX_LITERAL("8d969eef6ecad3c2");
+//
+// A malformed literal is a compile error. The functions can also be
+// called at run time, where they throw std::invalid_argument instead.
+//@}
+
+namespace codec_literal {
+
+//@{
+// @brief Returns the value of a digit in an alphabet.
+//
+// @param alphabet the alphabet.
+// @param radix number of digits in the alphabet.
+// @param c the digit.
+// @return value of the digit, negative if it is not in the alphabet.
+//@}
+constexpr int digit_value(const char *alphabet, size_t radix, char c) {
+  for (size_t i = 0; i < radix; ++i) {
+    if (alphabet[i] == c) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+//@{
+// @brief Returns the value of a hex digit of either case.
+//
+// @param c the digit.
+// @return value of the digit, negative if it is not a hex digit.
+//@}
+constexpr int hex_digit_value(char c) {
+  const int v = digit_value(codec_alphabet::hex_upper, 16, c);
+  return ((v < 0) ? digit_value(codec_alphabet::hex_lower, 16, c) : v);
+}
+
+//@{
+// @brief Hex decodes a string literal.
+//
+// @tparam _N size of the literal, terminating NUL included.
+// @param enc the literal.
+// @return the decoded bytes.
+//@}
+template <size_t _N>
+constexpr std::array<unsigned char, (_N - 1) / 2>
+hex_decode(const char (&enc)[_N]) {
+  static_assert(_N % 2 == 1, "Hex literal of odd length");
+
+  std::array<unsigned char, (_N - 1) / 2> dec{};
+  for (size_t i = 0; i < dec.size(); ++i) {
+    const int hi = hex_digit_value(enc[2 * i]);
+    const int lo = hex_digit_value(enc[2 * i + 1]);
+    if (hi < 0 || lo < 0) {
+      throw std::invalid_argument("codec_literal::hex_decode: Bad digit");
+    }
+    dec[i] = static_cast<unsigned char>((hi << 4) | lo);
+  }
+  return dec;
+}
+
+//@{
+// @brief Hex encodes bytes.
+//
+// @tparam _N number of bytes.
+// @param raw the bytes.
+// @param upper_case whether to use upper case digits.
+// @return the NUL terminated encoding.
+//@}
+template <size_t _N>
+constexpr std::array<char, 2 * _N + 1>
+hex_encode(const std::array<unsigned char, _N> &raw, bool upper_case = true) {
+  const char *const digits =
+      upper_case ? codec_alphabet::hex_upper : codec_alphabet::hex_lower;
+
+  std::array<char, 2 * _N + 1> enc{};
+  for (size_t i = 0; i < _N; ++i) {
+    enc[2 * i] = digits[raw[i] >> 4];
+    enc[2 * i + 1] = digits[raw[i] & 0xf];
+  }
+  return enc;
+}
+
+//@{
+// @brief Returns the number of Base-64 characters of a literal that carry
+// data, that is without the trailing padding.
+//
+// @tparam _N size of the literal, terminating NUL included.
+// @param enc the literal.
+// @return number of data characters.
+//@}
+template <size_t _N>
+constexpr size_t base64_data_len(const char (&enc)[_N]) {
+  size_t len = _N - 1;
+  while (len && enc[len - 1] == '=') {
+    --len;
+  }
+  return len;
+}
+
+//@{
+// @brief Returns the length a Base-64 literal decodes to.
+//
+// @tparam _N size of the literal, terminating NUL included.
+// @param enc the literal.
+// @return length of the decoded data.
+//@}
+template <size_t _N>
+constexpr size_t base64_decoded_len(const char (&enc)[_N]) {
+  const size_t len = base64_data_len(enc);
+  return (len / 4 * 3 + ((len % 4) ? len % 4 - 1 : 0));
+}
+
+//@{
+// @brief Base-64 decodes a string literal. With codec_alphabet::base64_std
+// the trailing padding may be omitted, but must otherwise be exact; with
+// codec_alphabet::base64_url there is none. The pad bits must be zero.
+//
+// @tparam _M length of the decoded data; base64_decoded_len() of enc.
+// @tparam _N size of the literal, terminating NUL included.
+// @param enc the literal.
+// @param alphabet codec_alphabet::base64_std or codec_alphabet::base64_url.
+// @return the decoded bytes.
+//@}
+template <size_t _M, size_t _N>
+constexpr std::array<unsigned char, _M>
+base64_decode(const char (&enc)[_N],
+              const char *alphabet = codec_alphabet::base64_std) {
+  const size_t len = base64_data_len(enc);
+  if (_M != base64_decoded_len(enc) || len % 4 == 1) {
+    throw std::invalid_argument("codec_literal::base64_decode: Bad length");
+  }
+  const size_t pad = _N - 1 - len;
+  if (pad && (alphabet == codec_alphabet::base64_url ||
+              pad != (4 - len % 4) % 4)) {
+    throw std::invalid_argument("codec_literal::base64_decode: Bad padding");
+  }
+
+  std::array<unsigned char, _M> dec{};
+  unsigned int acc = 0;
+  size_t bits = 0;
+  size_t out = 0;
+  for (size_t i = 0; i < len; ++i) {
+    const int v = digit_value(alphabet, 64, enc[i]);
+    if (v < 0) {
+      throw std::invalid_argument("codec_literal::base64_decode: Bad digit");
+    }
+    acc = (acc << 6) | static_cast<unsigned int>(v);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      dec[out++] = static_cast<unsigned char>(acc >> bits);
+      acc &= (1u << bits) - 1;
+    }
+  }
+  if (acc) {
+    throw std::invalid_argument("codec_literal::base64_decode: Bad padding");
+  }
+  return dec;
+}
+
+//@{
+// @brief Returns the length of the padded Base-64 encoding of raw data.
+//
+// @param raw_len length of raw data.
+// @return length of the encoded data.
+//@}
+constexpr size_t base64_encoded_len(size_t raw_len) {
+  return ((raw_len + 2) / 3 * 4);
+}
+
+//@{
+// @brief Base-64 encodes bytes, padded with codec_alphabet::base64_std.
+//
+// @tparam _N number of bytes.
+// @param raw the bytes.
+// @param alphabet codec_alphabet::base64_std or codec_alphabet::base64_url.
+// @return the NUL terminated encoding; without padding the terminator may
+// come before the end of the array.
+//@}
+template <size_t _N>
+constexpr std::array<char, base64_encoded_len(_N) + 1>
+base64_encode(const std::array<unsigned char, _N> &raw,
+              const char *alphabet = codec_alphabet::base64_std) {
+  // The array is zero filled, so leaving out the padding terminates early.
+  const char pad = (alphabet == codec_alphabet::base64_url) ? '\0' : '=';
+  std::array<char, base64_encoded_len(_N) + 1> enc{};
+  size_t out = 0;
+  for (size_t i = 0; i < _N; i += 3) {
+    const unsigned int v = (raw[i] << 16) |
+                           ((i + 1 < _N) ? raw[i + 1] << 8 : 0) |
+                           ((i + 2 < _N) ? raw[i + 2] : 0);
+    enc[out++] = alphabet[v >> 18];
+    enc[out++] = alphabet[(v >> 12) & 0x3f];
+    enc[out++] = (i + 1 < _N) ? alphabet[(v >> 6) & 0x3f] : pad;
+    enc[out++] = (i + 2 < _N) ? alphabet[v & 0x3f] : pad;
+  }
+  return enc;
+}
+
+} // namespace codec_literal
+
+} // namespace cryptcpp
+
+//@{
+// @brief Decode a Hex or Base-64 string literal during compilation into a
+// std::array<unsigned char, N>; a malformed literal does not compile.
+//@}
+#define CRYPTCPP_HEX_LITERAL(lit)                                              \
+  ([] {                                                                        \
+    constexpr auto _v = ::cryptcpp::codec_literal::hex_decode(lit);            \
+    return _v;                                                                 \
+  }())
+
+#define CRYPTCPP_BASE64_LITERAL(lit)                                           \
+  ([] {                                                                        \
+    constexpr auto _v = ::cryptcpp::codec_literal::base64_decode<              \
+        ::cryptcpp::codec_literal::base64_decoded_len(lit)>(lit);              \
+    return _v;                                                                 \
+  }())
+
+#define CRYPTCPP_BASE64URL_LITERAL(lit)                                        \
+  ([] {                                                                        \
+    constexpr auto _v = ::cryptcpp::codec_literal::base64_decode<              \
+        ::cryptcpp::codec_literal::base64_decoded_len(lit)>(                   \
+        lit, ::cryptcpp::codec_alphabet::base64_url);                          \
+    return _v;                                                                 \
+  }())
+
+#endif // C++17 or Higher
+
+#endif
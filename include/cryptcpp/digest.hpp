@@ -36,31 +36,274 @@ public:
   static inline digest_algorithm DIGEST_SHA512() { return "SHA512"; }
   static inline digest_algorithm DIGEST_MDC2() { return "MDC2"; }
   static inline digest_algorithm DIGEST_RIPEMD160() { return "RIPEMD160"; }
+  static inline digest_algorithm DIGEST_BLAKE2B512() { return "BLAKE2b512"; }
+  static inline digest_algorithm DIGEST_BLAKE2S256() { return "BLAKE2s256"; }
+  static inline digest_algorithm DIGEST_SHA3_224() { return "SHA3-224"; }
+  static inline digest_algorithm DIGEST_SHA3_256() { return "SHA3-256"; }
+  static inline digest_algorithm DIGEST_SHA3_384() { return "SHA3-384"; }
+  static inline digest_algorithm DIGEST_SHA3_512() { return "SHA3-512"; }
+
+  //@{
+  // @brief Extendable output functions. Their digest is as long as the
+  // output buffer given to calculate_digest() or final(), any length from
+  // 1 on; get_digest_len() is the default length of 16 and 32 bytes
+  // respectively, used by calculate_digest_batch() and the tree hash mode.
+  //@}
+  static inline digest_algorithm DIGEST_SHAKE128() { return "SHAKE128"; }
+  static inline digest_algorithm DIGEST_SHAKE256() { return "SHAKE256"; }
+
+  //@{
+  // @brief Tree hash mode of an algorithm, named "TREE-" followed by the
+  // algorithm, for example "TREE-SHA256". The input is split into chunks
+  // of 1 MiB that are hashed in parallel on up to get_num_threads()
+  // threads, and combined into the root of a Merkle tree as in RFC 6962:
+  //
+  //   leaf = H(0x00 || chunk)
+  //   node = H(0x01 || left || right)
+  //
+  // For n > 1 chunks, the left subtree holds the largest power of two
+  // less than n of them and the right subtree the rest. One chunk hashes
+  // to its leaf and an empty input to H() of no data. The digest is as
+  // long as that of the algorithm, but differs from it.
+  //@}
+  static inline digest_algorithm DIGEST_TREE_SHA256() { return "TREE-SHA256"; }
+
+  //@{
+  // @brief A segment of input data scattered over several buffers, such as
+  // the header, body fragments and trailer of a message.
+  //@}
+  struct data_segment {
+    const unsigned char *data; // The segment.
+    size_t data_len;           // Length of the segment.
+  };
+
+  //@{
+  // @brief Constructor.
+  //@}
+  digest() : _M_num_threads(1), _M_exportable(false) {}
 
   //@{
   // Polymorphic base class.
   //@}
   virtual ~digest() DFLTDSTR;
 
+  //@{
+  // @brief Sets the number of threads the tree hash mode may hash chunks
+  // on. The digest is the same as with a single thread.
+  //
+  // @param num_threads number of threads, 1 (the default) to stay on the
+  // calling thread.
+  //@}
+  void set_num_threads(size_t num_threads) {
+    _M_num_threads = num_threads ? num_threads : 1;
+  }
+
+  //@{
+  // @brief Returns the number of threads chunks may be hashed on.
+  //
+  // @return number of threads.
+  //@}
+  size_t get_num_threads() const { return _M_num_threads; }
+
+  //@{
+  // @brief Sets whether the calculations started by init() from now on
+  // may be exported with export_state(). An exportable calculation may be
+  // slower, so it is off by default.
+  //
+  // @param exportable true to make calculations exportable.
+  //@}
+  void set_exportable(bool exportable) { _M_exportable = exportable; }
+
+  //@{
+  // @brief Returns whether calculations started by init() are exportable.
+  //
+  // @return true if they are.
+  //@}
+  bool is_exportable() const { return _M_exportable; }
+
   //@{
   // @brief Calculates the digest of the given data.
   //
   // @param data input data whose digest is to be calculated.
   // @param data_len length of input data.
   // @param digest_buffer output buffer to write calculated digest.
-  // @param digest_buf_len maximum size of the output buffer.
+  // @param digest_buf_len maximum size of the output buffer, the length of
+  // the digest of an extendable output function.
   // @return length of the digest.
   //@}
   virtual size_t calculate_digest(const unsigned char *data, size_t data_len,
                                   unsigned char *digest_buf,
                                   size_t digest_buf_len) = 0;
 
+  //@{
+  // @brief Calculates the digest of data scattered over several buffers,
+  // as if they were concatenated, without concatenating them.
+  //
+  // @param segments the segments of input data, in order.
+  // @param num_segments number of segments.
+  // @param digest_buf output buffer to write calculated digest.
+  // @param digest_buf_len maximum size of the output buffer.
+  // @return length of the digest.
+  //@}
+  virtual size_t calculate_digest(const data_segment *segments,
+                                  size_t num_segments,
+                                  unsigned char *digest_buf,
+                                  size_t digest_buf_len) = 0;
+
+  //@{
+  // @brief Calculates the digest of the contents of a file in constant
+  // memory. Regular files are mapped into memory a window at a time and
+  // hashed in place, other files such as pipes are read in large blocks.
+  // Discards any incremental calculation in progress.
+  //
+  // @param path path of the file.
+  // @param digest_buf output buffer to write calculated digest.
+  // @param digest_buf_len size of the output buffer, at least
+  // get_digest_len().
+  // @return length of the digest, 0 on error.
+  //@}
+  virtual size_t calculate_file_digest(const char *path,
+                                       unsigned char *digest_buf,
+                                       size_t digest_buf_len) = 0;
+
+  //@{
+  // @brief Calculates the digests of a batch of independent messages,
+  // packed back to back, digest i at offset i * get_digest_len(). Much
+  // cheaper than a calculate_digest() per message for many small ones.
+  // Discards any incremental calculation in progress.
+  //
+  // @param count number of messages.
+  // @param data the messages.
+  // @param data_lens the lengths of the messages.
+  // @param digest_buf output buffer to write calculated digests.
+  // @param digest_buf_len size of the output buffer, at least count *
+  // get_digest_len().
+  // @return total length of the digests, 0 on error.
+  //@}
+  virtual size_t calculate_digest_batch(size_t count,
+                                        const unsigned char *const *data,
+                                        const size_t *data_lens,
+                                        unsigned char *digest_buf,
+                                        size_t digest_buf_len) = 0;
+
   //@{
   // @brief Sets the digest calculation algorithm to use.
   // @param _digest_algorithm the digest calculation algorithm to use.
   // @return true if successful.
   //@}
   virtual bool set_digest_algorithm(digest_algorithm digest_algo) = 0;
+
+  //@{
+  // @brief Returns the length of the digest of the algorithm set.
+  //
+  // @return length of the digest, 0 if no algorithm is set.
+  //@}
+  virtual size_t get_digest_len() const = 0;
+
+  //@{
+  // @brief Starts an incremental digest calculation, discarding any
+  // calculation in progress. The data is then fed through update() and
+  // the digest collected by final(), so a stream can be hashed without
+  // buffering all of it.
+  //
+  // @return true if successful.
+  //@}
+  virtual bool init() = 0;
+
+  //@{
+  // @brief Adds data to the digest calculation started by init().
+  //
+  // @param data the next chunk of the input data.
+  // @param data_len length of the chunk.
+  // @return true if successful.
+  //@}
+  virtual bool update(const unsigned char *data, size_t data_len) = 0;
+
+  //@{
+  // @brief Ends the digest calculation started by init(). Another one
+  // may be started with init().
+  //
+  // @param digest_buf output buffer to write calculated digest.
+  // @param digest_buf_len size of the output buffer, at least
+  // get_digest_len(); the length of the digest of an extendable output
+  // function.
+  // @return length of the digest, 0 on error.
+  //@}
+  virtual size_t final(unsigned char *digest_buf, size_t digest_buf_len) = 0;
+
+  //@{
+  // @brief Forks the calculation in progress in another digest of the same
+  // implementation. This digest takes over its algorithm and state, the
+  // other one is left as it is. Messages with a long common prefix then
+  // cost only their suffixes:
+  //
+  //   prefix->init();
+  //   prefix->update(salt, salt_len);
+  //   for each message:
+  //     d->copy_state(*prefix);
+  //     d->update(msg, msg_len);
+  //     d->final(digest_buf, digest_buf_len);
+  //
+  // @param src the digest to copy, with a calculation started by init().
+  // @return true if successful.
+  //@}
+  virtual bool copy_state(const digest &src) = 0;
+
+  //@{
+  // @brief Creates a new digest with the algorithm, number of threads and
+  // calculation in progress of this one. See copy_state(), which reuses
+  // an existing digest instead.
+  //
+  // @return pointer to the new digest, owned by the caller.
+  //@}
+  virtual digest *clone_state() const = 0;
+
+  //@{
+  // @brief Maximum length of a state exported by export_state().
+  //@}
+  static inline size_t DIGEST_STATE_MAX_LEN() { return 205; }
+
+  //@{
+  // @brief Exports the calculation in progress, so that it may be resumed
+  // with import_state() later or in another process, without hashing the
+  // data again. The state is a compact binary of a versioned format,
+  // independent of the platform, and holds the algorithm, the number of
+  // bytes hashed, the chaining value and the data of an incomplete block;
+  // it is not secret-free if the data is secret. The calculation must
+  // have been started by init() with set_exportable(), or resumed by
+  // import_state().
+  //
+  // @param state_buf output buffer to write the state.
+  // @param state_buf_len size of the output buffer; DIGEST_STATE_MAX_LEN()
+  // is always enough.
+  // @return length of the state, 0 on error or if the algorithm does not
+  // support exporting.
+  //@}
+  virtual size_t export_state(unsigned char *state_buf,
+                              size_t state_buf_len) const = 0;
+
+  //@{
+  // @brief Resumes a calculation exported by export_state(). This digest
+  // takes over its algorithm; update() and final() continue from it, and
+  // the calculation may be exported again.
+  //
+  // @param state_buf the exported state.
+  // @param state_buf_len length of the exported state.
+  // @return true if successful.
+  //@}
+  virtual bool import_state(const unsigned char *state_buf,
+                            size_t state_buf_len) = 0;
+
+protected:
+  //@{
+  // @brief Number of threads chunks may be hashed on.
+  //@}
+  size_t _M_num_threads;
+
+  //@{
+  // @brief Whether calculations started by init() are exportable.
+  //@}
+  bool _M_exportable;
 };
 
 } // namespace cryptcpp
@@ -22,15 +22,39 @@ namespace cryptcpp {
 class digital_signature : public asymmetric_key {
 
 public:
+  //@{
+  // @brief Constructor.
+  //@}
+  digital_signature() : _M_num_threads(1) {}
+
   //@{
   // @brief Polymorphic base class.
   //@}
   virtual ~digital_signature() DFLTDSTR;
 
   //@{
-  // @brief Digitally signs a digest with private key.
+  // @brief Sets the number of threads verify_batch() may verify on.
   //
-  // @param digest the digest to be digitally signed.
+  // @param num_threads number of threads, 1 (the default) to stay on the
+  // calling thread.
+  //@}
+  void set_num_threads(size_t num_threads) {
+    _M_num_threads = num_threads ? num_threads : 1;
+  }
+
+  //@{
+  // @brief Returns the number of threads verify_batch() may verify on.
+  //
+  // @return number of threads.
+  //@}
+  size_t get_num_threads() const { return _M_num_threads; }
+
+  //@{
+  // @brief Digitally signs data with private key. The data is hashed with
+  // the digest algorithm set and the hash signed; see sign_digest() for
+  // data already hashed.
+  //
+  // @param digest the data to be digitally signed.
   // @param digest_len length of the digest.
   // @param sig_buf output buffer where the signature is written.
   // @param sig_buf_len maximum length of the output buffer.
@@ -40,9 +64,11 @@ public:
                       unsigned char *sig_buf, size_t sig_buf_len) = 0;
 
   //@{
-  // @brief Verifies a digital signature against a digest using a public key.
+  // @brief Verifies a digital signature against data using a public key.
+  // The data is hashed with the digest algorithm set; see verify_digest()
+  // for data already hashed.
   //
-  // @param digest the digest the signature to verify against.
+  // @param digest the data the signature to verify against.
   // @param digest_len length of the digest.
   // @param signature the digital signature.
   // @param sig_len length of the digital signature.
@@ -52,13 +78,129 @@ public:
                       const unsigned char *signature, size_t sig_len) = 0;
 
   //@{
-  // @brief Set digest algorithm if valid.
+  // @brief Verifies the signatures of a batch of independent messages on
+  // up to get_num_threads() threads of a pool kept across calls. Each key
+  // is set up once per batch; each thread reuses its own context for its
+  // share of the messages.
+  //
+  // @param count number of messages.
+  // @param data the messages.
+  // @param data_lens the lengths of the messages.
+  // @param signatures the digital signatures.
+  // @param sig_lens the lengths of the digital signatures.
+  // @param verifiers for every message, the digital_signature of the same
+  // implementation whose public key and digest algorithm verify it, or
+  // nullptr for this one; nullptr to verify all of them with this one.
+  // @param results output: for every message, whether its signature
+  // verification passed.
+  // @return number of signatures whose verification passed.
+  //@}
+  virtual size_t verify_batch(size_t count, const unsigned char *const *data,
+                              const size_t *data_lens,
+                              const unsigned char *const *signatures,
+                              const size_t *sig_lens,
+                              const digital_signature *const *verifiers,
+                              bool *results) = 0;
+
+  //@{
+  // @brief Digitally signs a digest calculated beforehand, for example of a
+  // large document with a digest object, with private key. The signature
+  // is the same as that sign() makes of the document.
+  //
+  // @param digest the digest to be digitally signed, of the digest
+  // algorithm set.
+  // @param digest_len length of the digest.
+  // @param sig_buf output buffer where the signature is written.
+  // @param sig_buf_len maximum length of the output buffer.
+  // @return length of the digital signature.
+  //@}
+  virtual size_t sign_digest(const unsigned char *digest, size_t digest_len,
+                             unsigned char *sig_buf, size_t sig_buf_len) = 0;
+
+  //@{
+  // @brief Verifies a digital signature against a digest calculated
+  // beforehand using a public key.
+  //
+  // @param digest the digest the signature to verify against, of the
+  // digest algorithm set.
+  // @param digest_len length of the digest.
+  // @param signature the digital signature.
+  // @param sig_len length of the digital signature.
+  // @return true if signature verification passed, else false.
+  //@}
+  virtual bool verify_digest(const unsigned char *digest, size_t digest_len,
+                             const unsigned char *signature,
+                             size_t sig_len) = 0;
+
+  //@{
+  // @brief Starts signing data fed in chunks through sign_update(), so that
+  // a message of any size is signed in constant memory. The signature is
+  // the same as that sign() makes of the whole message.
+  //
+  // @return true if successful.
+  //@}
+  virtual bool sign_init() = 0;
+
+  //@{
+  // @brief Adds data to the signing started by sign_init().
+  //
+  // @param data the next chunk of the message.
+  // @param data_len length of the chunk.
+  // @return true if successful.
+  //@}
+  virtual bool sign_update(const unsigned char *data, size_t data_len) = 0;
+
+  //@{
+  // @brief Ends the signing started by sign_init().
+  //
+  // @param sig_buf output buffer where the signature is written.
+  // @param sig_buf_len maximum length of the output buffer.
+  // @return length of the digital signature.
+  //@}
+  virtual size_t sign_final(unsigned char *sig_buf, size_t sig_buf_len) = 0;
+
+  //@{
+  // @brief Starts verifying a signature against data fed in chunks through
+  // verify_update().
+  //
+  // @return true if successful.
+  //@}
+  virtual bool verify_init() = 0;
+
+  //@{
+  // @brief Adds data to the verification started by verify_init().
+  //
+  // @param data the next chunk of the message.
+  // @param data_len length of the chunk.
+  // @return true if successful.
+  //@}
+  virtual bool verify_update(const unsigned char *data, size_t data_len) = 0;
+
+  //@{
+  // @brief Ends the verification started by verify_init().
+  //
+  // @param signature the digital signature.
+  // @param sig_len length of the digital signature.
+  // @return true if signature verification passed, else false.
+  //@}
+  virtual bool verify_final(const unsigned char *signature,
+                            size_t sig_len) = 0;
+
+  //@{
+  // @brief Set digest algorithm if valid. Keys that hash the message
+  // themselves, such as EdDSA ones, ignore it.
   //
   // @param digest_algo to use in sign or verify.
   // @return true if successful.
   // @exception throw on openssl library call error.
   //@}
   virtual bool set_digest_algo(digest::digest_algorithm digest_algo) = 0;
+
+protected:
+  //@{
+  // @brief Number of threads batches may be verified on.
+  //@}
+  size_t _M_num_threads;
 };
 
 } // namespace cryptcpp
@@ -14,6 +14,8 @@
 #include "cryptcpp_cpp_std.hpp"
 #include "digest.hpp"
 #include "digital_signature.hpp"
+#include "mac.hpp"
+#include "multi_digest.hpp"
 #include "symmetric_key_crypt.hpp"
 
 #include <map>
@@ -66,6 +68,21 @@ public:
   //@}
   virtual digest *create_digest() const = 0;
 
+  //@{
+  // @brief Creates a new concrete calculator of the digests of several
+  // algorithms in one pass.
+  //
+  // @return pointer to the new concrete multi digest calculator.
+  //@}
+  virtual multi_digest *create_multi_digest() const = 0;
+
+  //@{
+  // @brief Creates a new concrete MAC calculator.
+  //
+  // @return pointer to the new concrete MAC calculator.
+  //@}
+  virtual mac *create_mac() const = 0;
+
   //@{
   // @brief Creates a new concrete asymmetric key crypt.
   //
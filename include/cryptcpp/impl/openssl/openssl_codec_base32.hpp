@@ -0,0 +1,188 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_OPENSSL_CODEC_BASE32_HPP__
+#define __CRYPTCPP_OPENSSL_CODEC_BASE32_HPP__
+
+#include <cryptcpp/codec.hpp>
+#include <cryptcpp/impl/openssl/openssl_codec_util.hpp>
+
+namespace cryptcpp {
+
+// =====================================================================
+//@{
+// This class implements the codec interface for Base-32 encoding/decoding
+// as in RFC 4648: CODEC_BASE32 with the standard alphabet and
+// CODEC_BASE32HEX with the extended hex alphabet. The output is padded to
+// whole 8-character blocks; decoding accepts letters of either case, and
+// decode() also accepts missing padding.
+//@}
+// =====================================================================
+
+class openssl_codec_base32 : public codec {
+
+public:
+  //@{
+  // @brief Constructor.
+  // @param codec_algo type of the codec.
+  //@}
+  explicit openssl_codec_base32(codec_algorithm codec_algo)
+      : codec(codec_algo) {}
+
+  //@{
+  // @brief Returns maximum size of encoded data for raw data size.
+  //
+  // @param raw_len length of raw data.
+  // @return maximum size of encoded data.
+  //@}
+  size_t get_max_encoded_buf_len(size_t raw_len) const OVERRIDE;
+
+  //@{
+  // @brief Returns maximum size of decoded data for encoded data size.
+  //
+  // @param enc_len length of encoded data.
+  // @return maximum size of decoded data.
+  //@}
+  size_t get_max_decoded_buf_len(size_t enc_len) const OVERRIDE;
+
+  //@{
+  // @brief Performs encoding.
+  //
+  // @param raw_buf the input data to be encoded.
+  // @param raw_len the length of the input data.
+  // @param enc_buf output buffer to write encoded data.
+  // @param enc_buf_len the length of the output buffer.
+  // @return length of encoded data, negative on error.
+  //@}
+  virtual ssize_t encode(const char *raw_buf, size_t raw_len, char *enc_buf,
+                         size_t enc_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Performs decoding.
+  //
+  // @param enc_buf the input data to be decoded.
+  // @param enc_len the length of the input data.
+  // @param dec_buf output buffer to write decoded data.
+  // @param dec_buf_len the length of the output buffer.
+  // @return length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode(const char *enc_buf, size_t enc_len, char *dec_buf,
+                         size_t dec_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Performs strict decoding, reporting failures through error
+  // codes.
+  //
+  // @param enc_buf the input data to be decoded.
+  // @param enc_len the length of the input data.
+  // @param dec_buf output buffer to write decoded data.
+  // @param dec_buf_len the length of the output buffer.
+  // @param error set to the reason of failure.
+  // @param error_offset set to the offset of the first invalid character.
+  // @return length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_strict(const char *enc_buf, size_t enc_len,
+                                char *dec_buf, size_t dec_buf_len,
+                                decode_error &error,
+                                size_t &error_offset) OVERRIDE;
+
+  //@{
+  // @brief Encodes a batch of buffers into one output arena.
+  //
+  // @param count number of input buffers.
+  // @param raw_bufs the input buffers.
+  // @param raw_lens the lengths of the input buffers.
+  // @param enc_buf output arena to write encoded data.
+  // @param enc_buf_len the length of the output arena.
+  // @param enc_offsets offsets of the encodings in the arena.
+  // @return total length of encoded data, negative on error.
+  //@}
+  virtual ssize_t encode_batch(size_t count, const char *const *raw_bufs,
+                               const size_t *raw_lens, char *enc_buf,
+                               size_t enc_buf_len,
+                               size_t *enc_offsets) OVERRIDE;
+
+  //@{
+  // @brief Decodes a batch of buffers into one output arena.
+  //
+  // @param count number of input buffers.
+  // @param enc_bufs the input buffers.
+  // @param enc_lens the lengths of the input buffers.
+  // @param dec_buf output arena to write decoded data.
+  // @param dec_buf_len the length of the output arena.
+  // @param dec_offsets offsets of the decodings in the arena.
+  // @return total length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_batch(size_t count, const char *const *enc_bufs,
+                               const size_t *enc_lens, char *dec_buf,
+                               size_t dec_buf_len,
+                               size_t *dec_offsets) OVERRIDE;
+
+  //@{
+  // @brief Encodes the next chunk of a stream.
+  //
+  // @param raw_buf the next chunk of the input data.
+  // @param raw_len the length of the chunk.
+  // @param enc_buf output buffer to write encoded data.
+  // @param enc_buf_len the length of the output buffer.
+  // @return length of encoded data, negative on error.
+  //@}
+  virtual ssize_t encode_update(const char *raw_buf, size_t raw_len,
+                                char *enc_buf, size_t enc_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Ends an encoding stream.
+  //
+  // @param enc_buf output buffer to write encoded data.
+  // @param enc_buf_len the length of the output buffer.
+  // @return length of encoded data, negative on error.
+  //@}
+  virtual ssize_t encode_final(char *enc_buf, size_t enc_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Decodes the next chunk of a stream.
+  //
+  // @param enc_buf the next chunk of the input data.
+  // @param enc_len the length of the chunk.
+  // @param dec_buf output buffer to write decoded data.
+  // @param dec_buf_len the length of the output buffer.
+  // @return length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_update(const char *enc_buf, size_t enc_len,
+                                char *dec_buf, size_t dec_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Ends a decoding stream.
+  //
+  // @param dec_buf output buffer to write decoded data.
+  // @param dec_buf_len the length of the output buffer.
+  // @return length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_final(char *dec_buf, size_t dec_buf_len) OVERRIDE;
+
+private:
+  //@{
+  // @brief Returns whether the codec uses the extended hex alphabet.
+  //
+  // @return true for CODEC_BASE32HEX.
+  //@}
+  bool use_hex_alphabet() const;
+
+  //@{
+  // @brief Encoder state of the current stream.
+  //@}
+  openssl_codec_util::base32_encoder _M_encoder;
+
+  //@{
+  // @brief Decoder state of the current stream.
+  //@}
+  openssl_codec_util::base32_decoder _M_decoder;
+};
+
+} // namespace cryptcpp
+#endif
@@ -10,13 +10,19 @@
 #define __CRYPTCPP_OPENSSL_CODEC_BASE64_HPP__
 
 #include <cryptcpp/codec.hpp>
+#include <cryptcpp/impl/openssl/openssl_codec_util.hpp>
 
 namespace cryptcpp {
 
 // =====================================================================
 //@{
 // This class implements the codec interface for Base-64
-// encoding/decoding using OpenSSL routines.
+// encoding/decoding. The output is byte-identical to OpenSSL's
+// Base-64 BIO filter, but is produced by the native vectorized engine
+// directly into the caller's buffer. CODEC_BASE64URL uses the URL and
+// filename safe alphabet without padding, as in JWTs; CODEC_BASE64_NOPAD
+// the standard alphabet without padding. decode() accepts the padding
+// either way; decode_strict() requires exactly the codec's own format.
 //@}
 // =====================================================================
 
@@ -69,6 +75,116 @@ public:
   //@}
   virtual ssize_t decode(const char *enc_buf, size_t enc_len, char *dec_buf,
                          size_t dec_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Performs strict decoding, reporting failures through error
+  // codes.
+  //
+  // @param enc_buf the input data to be decoded.
+  // @param enc_len the length of the input data.
+  // @param dec_buf output buffer to write decoded data.
+  // @param dec_buf_len the length of the output buffer.
+  // @param error set to the reason of failure.
+  // @param error_offset set to the offset of the first invalid character.
+  // @return length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_strict(const char *enc_buf, size_t enc_len,
+                                char *dec_buf, size_t dec_buf_len,
+                                decode_error &error,
+                                size_t &error_offset) OVERRIDE;
+
+  //@{
+  // @brief Encodes a batch of buffers into one output arena.
+  //
+  // @param count number of input buffers.
+  // @param raw_bufs the input buffers.
+  // @param raw_lens the lengths of the input buffers.
+  // @param enc_buf output arena to write encoded data.
+  // @param enc_buf_len the length of the output arena.
+  // @param enc_offsets offsets of the encodings in the arena.
+  // @return total length of encoded data, negative on error.
+  //@}
+  virtual ssize_t encode_batch(size_t count, const char *const *raw_bufs,
+                               const size_t *raw_lens, char *enc_buf,
+                               size_t enc_buf_len,
+                               size_t *enc_offsets) OVERRIDE;
+
+  //@{
+  // @brief Decodes a batch of buffers into one output arena.
+  //
+  // @param count number of input buffers.
+  // @param enc_bufs the input buffers.
+  // @param enc_lens the lengths of the input buffers.
+  // @param dec_buf output arena to write decoded data.
+  // @param dec_buf_len the length of the output arena.
+  // @param dec_offsets offsets of the decodings in the arena.
+  // @return total length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_batch(size_t count, const char *const *enc_bufs,
+                               const size_t *enc_lens, char *dec_buf,
+                               size_t dec_buf_len,
+                               size_t *dec_offsets) OVERRIDE;
+
+  //@{
+  // @brief Encodes the next chunk of a stream.
+  //
+  // @param raw_buf the next chunk of the input data.
+  // @param raw_len the length of the chunk.
+  // @param enc_buf output buffer to write encoded data.
+  // @param enc_buf_len the length of the output buffer.
+  // @return length of encoded data, negative on error.
+  //@}
+  virtual ssize_t encode_update(const char *raw_buf, size_t raw_len,
+                                char *enc_buf, size_t enc_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Ends an encoding stream.
+  //
+  // @param enc_buf output buffer to write encoded data.
+  // @param enc_buf_len the length of the output buffer.
+  // @return length of encoded data, negative on error.
+  //@}
+  virtual ssize_t encode_final(char *enc_buf, size_t enc_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Decodes the next chunk of a stream.
+  //
+  // @param enc_buf the next chunk of the input data.
+  // @param enc_len the length of the chunk.
+  // @param dec_buf output buffer to write decoded data.
+  // @param dec_buf_len the length of the output buffer.
+  // @return length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_update(const char *enc_buf, size_t enc_len,
+                                char *dec_buf, size_t dec_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Ends a decoding stream.
+  //
+  // @param dec_buf output buffer to write decoded data.
+  // @param dec_buf_len the length of the output buffer.
+  // @return length of the decoded data, negative on error.
+  //@}
+  virtual ssize_t decode_final(char *dec_buf, size_t dec_buf_len) OVERRIDE;
+
+private:
+  //@{
+  // @brief Returns the openssl_codec_util::base64_format flags of the
+  // codec algorithm.
+  //
+  // @return format flags.
+  //@}
+  int get_format() const;
+
+  //@{
+  // @brief Encoder state of the current stream.
+  //@}
+  openssl_codec_util::base64_encoder _M_encoder;
+
+  //@{
+  // @brief Decoder state of the current stream.
+  //@}
+  openssl_codec_util::base64_decoder _M_decoder;
 };
 
 } // namespace cryptcpp
@@ -0,0 +1,664 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_OPENSSL_CODEC_UTIL_HPP__
+#define __CRYPTCPP_OPENSSL_CODEC_UTIL_HPP__
+
+#include <cryptcpp/codec.hpp>
+#include <cryptcpp/cryptcpp_cpp_std.hpp>
+#include <cstdlib>
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace cryptcpp {
+
+//@{
+// @namespace openssl_codec_util
+// @brief Provides the native encoding/decoding engines used by the codecs.
+//
+// The engines write straight into the caller's buffers and never allocate.
+// Vectorized kernels (SSSE3, AVX2, AVX-512 VBMI) are selected once at
+// runtime based on the CPU, with a portable scalar fallback. Base-32 works
+// on whole 40-bit blocks and Base-58 on 32-bit limbs; Base-58 is the one
+// engine that may allocate, a single scratch block for large inputs.
+// Setting the CRYPTCPP_CODEC_SIMD environment variable to "avx2", "ssse3"
+// or "none" caps the selection.
+//@}
+
+namespace openssl_codec_util {
+
+//@{
+// @brief Decoding status reported by the decoding engines.
+//@}
+enum decode_status {
+  DECODE_OK,
+  DECODE_BAD_CHAR,
+  DECODE_BAD_PADDING,
+  DECODE_BAD_LENGTH,
+  DECODE_SHORT_BUFFER
+};
+
+//@{
+// @brief Returns the codec::decode_error of a decoding status.
+//
+// @param status the decoding status.
+// @return the decoding error.
+//@}
+codec::decode_error get_decode_error(decode_status status);
+
+//@{
+// @brief Base-64 format flags.
+//@}
+enum base64_format {
+  // Every 64 characters and the last line are terminated by a newline.
+  BASE64_WRAP_LINES = 0x1,
+  // The last group is not padded with '='.
+  BASE64_NO_PAD = 0x2,
+  // The URL and filename safe alphabet, with '-' and '_' for 62 and 63.
+  BASE64_URL = 0x4
+};
+
+//@{
+// @brief Base-64 encoder state carried across chunks of a stream.
+//@}
+struct base64_encoder {
+  //@{
+  // @brief Constructor. Starts a new stream.
+  //@}
+  base64_encoder() : carry_len(0), line_len(0) {}
+
+  unsigned char carry[3]; // Bytes of an incomplete group.
+  size_t carry_len;       // Number of bytes in carry.
+  size_t line_len;        // Characters on the current line.
+};
+
+//@{
+// @brief Base-64 decoder state carried across chunks of a stream.
+//@}
+struct base64_decoder {
+  //@{
+  // @brief Constructor. Starts a new stream.
+  //@}
+  base64_decoder() : acc(0), nsext(0), npad(0) {}
+
+  unsigned int acc;   // Sextets of the current group.
+  unsigned int nsext; // Number of sextets in acc.
+  unsigned int npad;  // Padding characters seen.
+};
+
+//@{
+// @brief Hex decoder state carried across chunks of a stream.
+//@}
+struct hex_decoder {
+  //@{
+  // @brief Constructor. Starts a new stream.
+  //@}
+  hex_decoder() : carry(0), has_carry(false) {}
+
+  char carry;     // First digit of an incomplete pair.
+  bool has_carry; // Whether carry is set.
+};
+
+//@{
+// @brief Base-32 encoder state carried across chunks of a stream.
+//@}
+struct base32_encoder {
+  //@{
+  // @brief Constructor. Starts a new stream.
+  //@}
+  base32_encoder() : carry_len(0) {}
+
+  unsigned char carry[5]; // Bytes of an incomplete block.
+  size_t carry_len;       // Number of bytes in carry.
+};
+
+//@{
+// @brief Base-32 decoder state carried across chunks of a stream.
+//@}
+struct base32_decoder {
+  //@{
+  // @brief Constructor. Starts a new stream.
+  //@}
+  base32_decoder() : acc(0), nchars(0), npad(0) {}
+
+  uint64_t acc;        // Quintets of the current block.
+  unsigned int nchars; // Number of quintets in acc.
+  unsigned int npad;   // Padding characters seen.
+};
+
+//@{
+// @brief Returns the exact length of the Base-64 encoding of raw data.
+//
+// @param raw_len length of raw data.
+// @param format base64_format flags.
+// @return length of the encoded data.
+//@}
+size_t base64_encoded_len(size_t raw_len, int format);
+
+//@{
+// @brief Returns the exact length base64_encode_update() will produce.
+//
+// @param state the encoder state.
+// @param raw_len length of the next chunk of raw data.
+// @param format base64_format flags.
+// @return length of the encoded data.
+//@}
+size_t base64_encode_update_len(const base64_encoder &state, size_t raw_len,
+                                int format);
+
+//@{
+// @brief Base-64 encodes the next chunk of a stream. An incomplete
+// trailing group is held in the state until more data arrives.
+//
+// @param state the encoder state.
+// @param raw the input data to be encoded.
+// @param raw_len the length of the input data.
+// @param enc output buffer, at least base64_encode_update_len() long.
+// @param format base64_format flags.
+// @return length of the encoded data.
+//@}
+size_t base64_encode_update(base64_encoder &state, const unsigned char *raw,
+                            size_t raw_len, char *enc, int format);
+
+//@{
+// @brief Returns the exact length base64_encode_final() will produce.
+//
+// @param state the encoder state.
+// @param format base64_format flags.
+// @return length of the encoded data.
+//@}
+size_t base64_encode_final_len(const base64_encoder &state, int format);
+
+//@{
+// @brief Ends a Base-64 encoding stream, writing the padded last group
+// and the last newline. The state is reset for a new stream.
+//
+// @param state the encoder state.
+// @param enc output buffer, at least base64_encode_final_len() long.
+// @param format base64_format flags.
+// @return length of the encoded data.
+//@}
+size_t base64_encode_final(base64_encoder &state, char *enc, int format);
+
+//@{
+// @brief Base-64 encodes raw data.
+//
+// @param raw the input data to be encoded.
+// @param raw_len the length of the input data.
+// @param enc output buffer, at least base64_encoded_len() long.
+// @param format base64_format flags.
+// @param num_threads number of threads a large input may be split over.
+// @return length of the encoded data.
+//@}
+size_t base64_encode(const unsigned char *raw, size_t raw_len, char *enc,
+                     int format, size_t num_threads);
+
+//@{
+// @brief Base-64 decodes the next chunk of a stream. An incomplete
+// trailing group is held in the state until more data arrives.
+//
+// @param state the decoder state.
+// @param enc the input data to be decoded.
+// @param enc_len the length of the input data.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param format base64_format flags; only BASE64_URL matters.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base64_decode_update(base64_decoder &state, const char *enc,
+                             size_t enc_len, unsigned char *dec,
+                             size_t dec_len, int format,
+                             decode_status &status);
+
+//@{
+// @brief Ends a Base-64 decoding stream, flushing the unpadded last
+// group. The state is reset for a new stream.
+//
+// @param state the decoder state.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base64_decode_final(base64_decoder &state, unsigned char *dec,
+                            size_t dec_len, decode_status &status);
+
+//@{
+// @brief Base-64 decodes encoded data. Whitespace is skipped and the
+// trailing padding may be omitted. dec may be enc to decode in place.
+//
+// @param enc the input data to be decoded.
+// @param enc_len the length of the input data.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param format base64_format flags; only BASE64_URL matters.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base64_decode(const char *enc, size_t enc_len, unsigned char *dec,
+                      size_t dec_len, int format, decode_status &status);
+
+//@{
+// @brief Base-64 decodes encoded data strictly: whitespace other than the
+// newlines of BASE64_WRAP_LINES, padding that BASE64_NO_PAD forbids or
+// that is otherwise missing or incomplete, and non-zero pad bits are all
+// errors. dec may be enc to decode in place.
+//
+// @param enc the input data to be decoded.
+// @param enc_len the length of the input data.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param format base64_format flags.
+// @param status set to the reason of failure.
+// @param error_offset set on error to the offset of the offending
+// character, or enc_len if the input ends early.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base64_decode_strict(const char *enc, size_t enc_len,
+                             unsigned char *dec, size_t dec_len, int format,
+                             decode_status &status, size_t &error_offset);
+
+//@{
+// @brief Base-64 encodes a batch of buffers back to back into one arena.
+//
+// @param count number of input buffers.
+// @param raw the input buffers.
+// @param raw_lens the lengths of the input buffers.
+// @param enc output arena, at least the sum of base64_encoded_len() of
+// all inputs long.
+// @param enc_offsets count + 1 entries; entry i is set to the offset of
+// the encoding of input i and entry count to the total length.
+// @param format base64_format flags.
+// @return length of the encoded data.
+//@}
+size_t base64_encode_batch(size_t count, const char *const *raw,
+                           const size_t *raw_lens, char *enc,
+                           size_t *enc_offsets, int format);
+
+//@{
+// @brief Base-64 decodes a batch of buffers back to back into one arena.
+//
+// @param count number of input buffers.
+// @param enc the input buffers.
+// @param enc_lens the lengths of the input buffers.
+// @param dec output arena to write decoded data.
+// @param dec_len the length of the output arena.
+// @param dec_offsets count + 1 entries; entry i is set to the offset of
+// the decoding of input i and entry count to the total length.
+// @param format base64_format flags; only BASE64_URL matters.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base64_decode_batch(size_t count, const char *const *enc,
+                            const size_t *enc_lens, unsigned char *dec,
+                            size_t dec_len, size_t *dec_offsets, int format,
+                            decode_status &status);
+
+//@{
+// @brief Hex encodes raw data, two digits per byte.
+//
+// @param raw the input data to be encoded.
+// @param raw_len the length of the input data.
+// @param enc output buffer, at least 2 * raw_len long.
+// @param upper_case whether to use upper case digits.
+// @param num_threads number of threads a large input may be split over.
+// @return length of the encoded data.
+//@}
+size_t hex_encode(const unsigned char *raw, size_t raw_len, char *enc,
+                  bool upper_case, size_t num_threads);
+
+//@{
+// @brief Hex decodes encoded data of even length. Digits of either case
+// are accepted; any other character is an error. dec may be enc to
+// decode in place.
+//
+// @param enc the input data to be decoded.
+// @param enc_len the length of the input data.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param status set to the reason of failure.
+// @param num_threads number of threads a large input may be split over.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t hex_decode(const char *enc, size_t enc_len, unsigned char *dec,
+                   size_t dec_len, decode_status &status, size_t num_threads);
+
+//@{
+// @brief Hex decodes encoded data as hex_decode() does, also reporting
+// where decoding failed.
+//
+// @param enc the input data to be decoded.
+// @param enc_len the length of the input data.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param status set to the reason of failure.
+// @param error_offset set on error to the offset of the offending
+// character, or enc_len if the input ends early.
+// @param num_threads number of threads a large input may be split over.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t hex_decode_strict(const char *enc, size_t enc_len, unsigned char *dec,
+                          size_t dec_len, decode_status &status,
+                          size_t &error_offset, size_t num_threads);
+
+//@{
+// @brief Hex decodes the next chunk of a stream. A digit without its
+// pair is held in the state until more data arrives.
+//
+// @param state the decoder state.
+// @param enc the input data to be decoded.
+// @param enc_len the length of the input data.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t hex_decode_update(hex_decoder &state, const char *enc, size_t enc_len,
+                          unsigned char *dec, size_t dec_len,
+                          decode_status &status);
+
+//@{
+// @brief Ends a hex decoding stream. The state is reset for a new stream.
+//
+// @param state the decoder state.
+// @param status set to the reason of failure.
+// @return 0, negative if a digit was left without its pair.
+//@}
+ssize_t hex_decode_final(hex_decoder &state, decode_status &status);
+
+//@{
+// @brief Hex encodes a batch of buffers back to back into one arena.
+//
+// @param count number of input buffers.
+// @param raw the input buffers.
+// @param raw_lens the lengths of the input buffers.
+// @param enc output arena, at least twice the total input length long.
+// @param enc_offsets count + 1 entries; entry i is set to the offset of
+// the encoding of input i and entry count to the total length.
+// @param upper_case whether to use upper case digits.
+// @return length of the encoded data.
+//@}
+size_t hex_encode_batch(size_t count, const char *const *raw,
+                        const size_t *raw_lens, char *enc, size_t *enc_offsets,
+                        bool upper_case);
+
+//@{
+// @brief Hex decodes a batch of buffers back to back into one arena.
+//
+// @param count number of input buffers.
+// @param enc the input buffers.
+// @param enc_lens the lengths of the input buffers.
+// @param dec output arena to write decoded data.
+// @param dec_len the length of the output arena.
+// @param dec_offsets count + 1 entries; entry i is set to the offset of
+// the decoding of input i and entry count to the total length.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t hex_decode_batch(size_t count, const char *const *enc,
+                         const size_t *enc_lens, unsigned char *dec,
+                         size_t dec_len, size_t *dec_offsets,
+                         decode_status &status);
+
+//@{
+// @brief Returns the exact length of the Base-32 encoding of raw data,
+// padded to whole 8-character blocks.
+//
+// @param raw_len length of raw data.
+// @return length of the encoded data.
+//@}
+size_t base32_encoded_len(size_t raw_len);
+
+//@{
+// @brief Returns the exact length base32_encode_update() will produce.
+//
+// @param state the encoder state.
+// @param raw_len length of the next chunk of raw data.
+// @return length of the encoded data.
+//@}
+size_t base32_encode_update_len(const base32_encoder &state, size_t raw_len);
+
+//@{
+// @brief Base-32 encodes the next chunk of a stream. An incomplete
+// trailing block is held in the state until more data arrives.
+//
+// @param state the encoder state.
+// @param raw the input data to be encoded.
+// @param raw_len the length of the input data.
+// @param enc output buffer, at least base32_encode_update_len() long.
+// @param hex_alphabet whether to use the extended hex alphabet.
+// @return length of the encoded data.
+//@}
+size_t base32_encode_update(base32_encoder &state, const unsigned char *raw,
+                            size_t raw_len, char *enc, bool hex_alphabet);
+
+//@{
+// @brief Returns the exact length base32_encode_final() will produce.
+//
+// @param state the encoder state.
+// @return length of the encoded data.
+//@}
+size_t base32_encode_final_len(const base32_encoder &state);
+
+//@{
+// @brief Ends a Base-32 encoding stream, writing the padded last block.
+// The state is reset for a new stream.
+//
+// @param state the encoder state.
+// @param enc output buffer, at least base32_encode_final_len() long.
+// @param hex_alphabet whether to use the extended hex alphabet.
+// @return length of the encoded data.
+//@}
+size_t base32_encode_final(base32_encoder &state, char *enc,
+                           bool hex_alphabet);
+
+//@{
+// @brief Base-32 encodes raw data.
+//
+// @param raw the input data to be encoded.
+// @param raw_len the length of the input data.
+// @param enc output buffer, at least base32_encoded_len() long.
+// @param hex_alphabet whether to use the extended hex alphabet.
+// @param num_threads number of threads a large input may be split over.
+// @return length of the encoded data.
+//@}
+size_t base32_encode(const unsigned char *raw, size_t raw_len, char *enc,
+                     bool hex_alphabet, size_t num_threads);
+
+//@{
+// @brief Base-32 decodes the next chunk of a stream. An incomplete
+// trailing block is held in the state until more data arrives.
+//
+// @param state the decoder state.
+// @param enc the input data to be decoded.
+// @param enc_len the length of the input data.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param hex_alphabet whether to use the extended hex alphabet.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base32_decode_update(base32_decoder &state, const char *enc,
+                             size_t enc_len, unsigned char *dec,
+                             size_t dec_len, bool hex_alphabet,
+                             decode_status &status);
+
+//@{
+// @brief Ends a Base-32 decoding stream, flushing the unpadded last
+// block. The state is reset for a new stream.
+//
+// @param state the decoder state.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base32_decode_final(base32_decoder &state, unsigned char *dec,
+                            size_t dec_len, decode_status &status);
+
+//@{
+// @brief Base-32 decodes encoded data. Letters of either case are
+// accepted, whitespace is skipped and the trailing padding may be
+// omitted. dec may be enc to decode in place.
+//
+// @param enc the input data to be decoded.
+// @param enc_len the length of the input data.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param hex_alphabet whether to use the extended hex alphabet.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base32_decode(const char *enc, size_t enc_len, unsigned char *dec,
+                      size_t dec_len, bool hex_alphabet,
+                      decode_status &status);
+
+//@{
+// @brief Base-32 decodes encoded data strictly: whitespace, missing or
+// incomplete padding and non-zero pad bits are all errors. Letters of
+// either case are accepted. dec may be enc to decode in place.
+//
+// @param enc the input data to be decoded.
+// @param enc_len the length of the input data.
+// @param dec output buffer to write decoded data.
+// @param dec_len the length of the output buffer.
+// @param hex_alphabet whether to use the extended hex alphabet.
+// @param status set to the reason of failure.
+// @param error_offset set on error to the offset of the offending
+// character, or enc_len if the input ends early.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base32_decode_strict(const char *enc, size_t enc_len,
+                             unsigned char *dec, size_t dec_len,
+                             bool hex_alphabet, decode_status &status,
+                             size_t &error_offset);
+
+//@{
+// @brief Base-32 encodes a batch of buffers back to back into one arena.
+//
+// @param count number of input buffers.
+// @param raw the input buffers.
+// @param raw_lens the lengths of the input buffers.
+// @param enc output arena, at least the sum of base32_encoded_len() of
+// all inputs long.
+// @param enc_offsets count + 1 entries; entry i is set to the offset of
+// the encoding of input i and entry count to the total length.
+// @param hex_alphabet whether to use the extended hex alphabet.
+// @return length of the encoded data.
+//@}
+size_t base32_encode_batch(size_t count, const char *const *raw,
+                           const size_t *raw_lens, char *enc,
+                           size_t *enc_offsets, bool hex_alphabet);
+
+//@{
+// @brief Base-32 decodes a batch of buffers back to back into one arena.
+//
+// @param count number of input buffers.
+// @param enc the input buffers.
+// @param enc_lens the lengths of the input buffers.
+// @param dec output arena to write decoded data.
+// @param dec_len the length of the output arena.
+// @param dec_offsets count + 1 entries; entry i is set to the offset of
+// the decoding of input i and entry count to the total length.
+// @param hex_alphabet whether to use the extended hex alphabet.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base32_decode_batch(size_t count, const char *const *enc,
+                            const size_t *enc_lens, unsigned char *dec,
+                            size_t dec_len, size_t *dec_offsets,
+                            bool hex_alphabet, decode_status &status);
+
+//@{
+// @brief Returns an upper bound of the length of the Base-58 encoding of
+// raw data.
+//
+// @param raw_len length of raw data.
+// @return maximum length of the encoded data.
+//@}
+size_t base58_max_encoded_len(size_t raw_len);
+
+//@{
+// @brief Base-58 encodes raw data with the Bitcoin alphabet.
+//
+// @param raw the input data to be encoded.
+// @param raw_len the length of the input data.
+// @param enc output buffer; base58_max_encoded_len() is always enough.
+// @param enc_len the length of the output buffer.
+// @return length of the encoded data, negative if the buffer is short.
+//@}
+ssize_t base58_encode(const unsigned char *raw, size_t raw_len, char *enc,
+                      size_t enc_len);
+
+//@{
+// @brief Base-58 decodes encoded data. Any character outside the
+// alphabet, whitespace included, is an error. dec may be enc to decode in
+// place.
+//
+// @param enc the input data to be decoded.
+// @param enc_len the length of the input data.
+// @param dec output buffer; enc_len is always enough.
+// @param dec_len the length of the output buffer.
+// @param status set to the reason of failure.
+// @param error_offset set on error to the offset of the offending
+// character, or enc_len if the buffer is short.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base58_decode(const char *enc, size_t enc_len, unsigned char *dec,
+                      size_t dec_len, decode_status &status,
+                      size_t &error_offset);
+
+//@{
+// @brief Base-58 encodes a batch of buffers back to back into one arena.
+//
+// @param count number of input buffers.
+// @param raw the input buffers.
+// @param raw_lens the lengths of the input buffers.
+// @param enc output arena; the sum of base58_max_encoded_len() of all
+// inputs is always enough.
+// @param enc_len the length of the output arena.
+// @param enc_offsets count + 1 entries; entry i is set to the offset of
+// the encoding of input i and entry count to the total length.
+// @return length of the encoded data, negative if the arena is short.
+//@}
+ssize_t base58_encode_batch(size_t count, const char *const *raw,
+                            const size_t *raw_lens, char *enc,
+                            size_t enc_len, size_t *enc_offsets);
+
+//@{
+// @brief Base-58 decodes a batch of buffers back to back into one arena.
+//
+// @param count number of input buffers.
+// @param enc the input buffers.
+// @param enc_lens the lengths of the input buffers.
+// @param dec output arena to write decoded data.
+// @param dec_len the length of the output arena.
+// @param dec_offsets count + 1 entries; entry i is set to the offset of
+// the decoding of input i and entry count to the total length.
+// @param status set to the reason of failure.
+// @return length of the decoded data, negative on error.
+//@}
+ssize_t base58_decode_batch(size_t count, const char *const *enc,
+                            const size_t *enc_lens, unsigned char *dec,
+                            size_t dec_len, size_t *dec_offsets,
+                            decode_status &status);
+
+//@{
+// @brief Reports a failed decoding through report_exception(), so that
+// every codec fails alike on malformed input and on a short buffer.
+//
+// @param func the failing function, prefixed to the error message.
+// @param status the decoding status; DECODE_OK reports nothing.
+//@}
+void report_decode_status(const char *func, decode_status status);
+
+} // namespace openssl_codec_util
+
+} // namespace cryptcpp
+#endif
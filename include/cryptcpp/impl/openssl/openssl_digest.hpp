@@ -14,10 +14,19 @@
 
 namespace cryptcpp {
 
+namespace openssl_digest_util {
+struct tree_state;
+struct sha_state;
+} // namespace openssl_digest_util
+
 //@{
 // @class openssl_digest
 // @brief Implements the digest interface for digest/hash
 // calculation using openssl routines.
+//
+// One digest context is kept for the lifetime of the object and
+// re-initialized for every calculation, so an object must not be used by
+// several threads at once.
 //@}
 
 class openssl_digest : public digest {
@@ -30,6 +39,11 @@ public:
   //@}
   explicit openssl_digest();
 
+  //@{
+  // @brief Destructor.
+  //@}
+  virtual ~openssl_digest();
+
   //@{
   // @brief calculates the digest of the given data.
   //
@@ -43,6 +57,56 @@ public:
                                   unsigned char *digest_buf,
                                   size_t digest_buf_len) OVERRIDE;
 
+  //@{
+  // @brief Calculates the digest of data scattered over several buffers.
+  // The segments are fed one after the other to the same digest context.
+  //
+  // @param segments the segments of input data, in order.
+  // @param num_segments number of segments.
+  // @param digest_buf output buffer to write calculated digest.
+  // @param digest_buf_len maximum size of the output buffer.
+  // @return length of the digest.
+  // @throw on ssl library call error.
+  //@}
+  virtual size_t calculate_digest(const data_segment *segments,
+                                  size_t num_segments,
+                                  unsigned char *digest_buf,
+                                  size_t digest_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Calculates the digest of the contents of a file. Regular files
+  // are mapped in windows of 64 MiB advised for sequential access, other
+  // files are read into a page aligned buffer of 1 MiB.
+  //
+  // @param path path of the file.
+  // @param digest_buf output buffer to write calculated digest.
+  // @param digest_buf_len size of the output buffer.
+  // @return length of the digest.
+  // @throw on file access or ssl library call error.
+  //@}
+  virtual size_t calculate_file_digest(const char *path,
+                                       unsigned char *digest_buf,
+                                       size_t digest_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Calculates the digests of a batch of independent messages.
+  // SHA-1 and SHA-256 of the default provider use a multi-buffer engine
+  // when the CPU has one, other algorithms a single reused digest context.
+  //
+  // @param count number of messages.
+  // @param data the messages.
+  // @param data_lens the lengths of the messages.
+  // @param digest_buf output buffer to write calculated digests.
+  // @param digest_buf_len size of the output buffer.
+  // @return total length of the digests.
+  // @throw on ssl library call error.
+  //@}
+  virtual size_t calculate_digest_batch(size_t count,
+                                        const unsigned char *const *data,
+                                        const size_t *data_lens,
+                                        unsigned char *digest_buf,
+                                        size_t digest_buf_len) OVERRIDE;
+
   //@{
   // @brief Sets the digest calculation algorithm to use.
   // @param _digest_algorithm the digest calculation algorithm to use.
@@ -51,11 +115,127 @@ public:
   //@}
   virtual bool set_digest_algorithm(digest_algorithm digest_algo) OVERRIDE;
 
+  //@{
+  // @brief Returns the length of the digest of the algorithm set.
+  //
+  // @return length of the digest, 0 if no algorithm is set.
+  //@}
+  virtual size_t get_digest_len() const OVERRIDE;
+
+  //@{
+  // @brief Starts an incremental digest calculation.
+  //
+  // @return true if successful.
+  // @throw on ssl library call error.
+  //@}
+  virtual bool init() OVERRIDE;
+
+  //@{
+  // @brief Adds data to the digest calculation.
+  //
+  // @param data the next chunk of the input data.
+  // @param data_len length of the chunk.
+  // @return true if successful.
+  // @throw on ssl library call error.
+  //@}
+  virtual bool update(const unsigned char *data, size_t data_len) OVERRIDE;
+
+  //@{
+  // @brief Ends the digest calculation.
+  //
+  // @param digest_buf output buffer to write calculated digest.
+  // @param digest_buf_len size of the output buffer.
+  // @return length of the digest.
+  // @throw on ssl library call error.
+  //@}
+  virtual size_t final(unsigned char *digest_buf,
+                       size_t digest_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Forks the calculation in progress in another openssl_digest.
+  // The digest context is copied into the one of this object, which is
+  // only allocated the first time.
+  //
+  // @param src the digest to copy.
+  // @return true if successful.
+  // @throw on ssl library call error or if src is not an openssl_digest.
+  //@}
+  virtual bool copy_state(const digest &src) OVERRIDE;
+
+  //@{
+  // @brief Creates a new digest with a copy of the state of this one.
+  //
+  // @return pointer to the new digest.
+  // @throw on ssl library call error.
+  //@}
+  virtual digest *clone_state() const OVERRIDE;
+
+  //@{
+  // @brief Exports the calculation in progress. Exportable SHA-1 and
+  // SHA-2 calculations of the default provider run on the low level
+  // OpenSSL contexts instead of EVP for this; other algorithms and the
+  // tree hash mode are not exportable.
+  //
+  // @param state_buf output buffer to write the state.
+  // @param state_buf_len size of the output buffer.
+  // @return length of the state.
+  // @throw if the digest is not started or not exportable, or if the buffer
+  // is short.
+  //@}
+  virtual size_t export_state(unsigned char *state_buf,
+                              size_t state_buf_len) const OVERRIDE;
+
+  //@{
+  // @brief Resumes an exported calculation.
+  //
+  // @param state_buf the exported state.
+  // @param state_buf_len length of the exported state.
+  // @return true if successful.
+  // @throw on a malformed state, or if its algorithm is not supported.
+  //@}
+  virtual bool import_state(const unsigned char *state_buf,
+                            size_t state_buf_len) OVERRIDE;
+
 private:
+  //@{
+  // @brief Returns whether the digest is of an extendable output function,
+  // whose length is chosen by the caller.
+  //
+  // @return true for SHAKE128 and SHAKE256 outside the tree hash mode.
+  //@}
+  bool is_xof() const;
+
+  //@{
+  // @brief Not copyable; the digest context is owned.
+  //@}
+  openssl_digest(const openssl_digest &) DELETED;
+  openssl_digest &operator=(const openssl_digest &) DELETED;
+
   //@{
   // @brief The OpenSSL message digest structure.
   //@}
   const EVP_MD *_M_md;
+
+  //@{
+  // @brief _M_md when fetched from a provider and owned, else nullptr.
+  //@}
+  EVP_MD *_M_fetched_md;
+
+  //@{
+  // @brief The digest context, reused across calculations.
+  //@}
+  EVP_MD_CTX *_M_mdctx;
+
+  //@{
+  // @brief State of the tree hash mode of _M_md, nullptr if not in it.
+  //@}
+  openssl_digest_util::tree_state *_M_tree;
+
+  //@{
+  // @brief Low level state _M_md is calculated on when the calculation
+  // is exportable, nullptr if it is calculated on the digest context.
+  //@}
+  openssl_digest_util::sha_state *_M_sha;
 };
 
 } // namespace cryptcpp
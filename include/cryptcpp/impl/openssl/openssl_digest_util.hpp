@@ -0,0 +1,198 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_OPENSSL_DIGEST_UTIL_HPP__
+#define __CRYPTCPP_OPENSSL_DIGEST_UTIL_HPP__
+
+#include <cryptcpp/cryptcpp_cpp_std.hpp>
+#include <cstdlib>
+#include <openssl/ossl_typ.h>
+#include <stdint.h>
+#include <vector>
+
+namespace cryptcpp {
+
+//@{
+// @namespace openssl_digest_util
+// @brief Provides the native multi-buffer digest engines used by the
+// digests for batches of independent messages.
+//
+// A multi-buffer engine hashes one block of several messages at a time,
+// one message per 32-bit lane of a vector register (8 lanes on AVX2, 16 on
+// AVX-512). A lane is refilled with the next message as soon as its
+// message is done, so messages of different lengths share the lanes. The
+// kernels are selected once at runtime based on the CPU; there is no
+// scalar engine, callers fall back to the EVP routines.
+//
+// Also provides the tree hash mode, which hashes the chunks of large
+// inputs on several threads and combines them into a Merkle tree, and
+// SHA-1 and SHA-2 calculations on the low level OpenSSL contexts, whose
+// state can be exported and imported unlike that of an EVP context.
+//@}
+
+namespace openssl_digest_util {
+
+//@{
+// @brief Algorithms with a multi-buffer engine.
+//@}
+enum mb_algorithm { MB_SHA1, MB_SHA256 };
+
+//@{
+// @brief Returns the number of lanes of the multi-buffer engine of an
+// algorithm on the running CPU.
+//
+// @param algo the digest algorithm.
+// @return number of lanes, 0 if there is no engine for this CPU.
+//@}
+size_t mb_lanes(mb_algorithm algo);
+
+//@{
+// @brief Calculates the digests of a batch of messages with the
+// multi-buffer engine, which must be available.
+//
+// @param algo the digest algorithm.
+// @param count number of messages.
+// @param data the messages.
+// @param data_lens the lengths of the messages.
+// @param digests output buffer; digest i is written at offset i times the
+// digest length.
+//@}
+void mb_digest_batch(mb_algorithm algo, size_t count,
+                     const unsigned char *const *data, const size_t *data_lens,
+                     unsigned char *digests);
+
+//@{
+// @brief Length of the chunks of the tree hash mode, its leaves.
+//@}
+static const size_t TREE_CHUNK_LEN = 1024 * 1024;
+
+//@{
+// @brief Tree hash state carried across chunks of a stream.
+//
+// The roots of the complete subtrees hashed so far are stacked with
+// strictly decreasing leaf counts, so the stack stays logarithmic in the
+// length of the input.
+//@}
+struct tree_state {
+  std::vector<unsigned char> carry;  // Data of an incomplete chunk.
+  std::vector<unsigned char> roots;  // Roots of the subtrees, in order.
+  std::vector<uint64_t> root_leaves; // Leaves under each root.
+};
+
+//@{
+// @brief Adds data to a tree hash. Whole chunks of the data are hashed
+// in parallel.
+//
+// @param state the tree hash state.
+// @param md the digest algorithm of the nodes.
+// @param ctx digest context to hash with on the calling thread.
+// @param data the next chunk of the input data.
+// @param data_len length of the data.
+// @param num_threads maximum number of threads to use.
+// @return true if successful.
+//@}
+bool tree_update(tree_state &state, const EVP_MD *md, EVP_MD_CTX *ctx,
+                 const unsigned char *data, size_t data_len,
+                 size_t num_threads);
+
+//@{
+// @brief Ends a tree hash and resets the state for the next one.
+//
+// @param state the tree hash state.
+// @param md the digest algorithm of the nodes.
+// @param ctx digest context to hash with.
+// @param digest output buffer of the digest length of md.
+// @return true if successful.
+//@}
+bool tree_final(tree_state &state, const EVP_MD *md, EVP_MD_CTX *ctx,
+                unsigned char *digest);
+
+//@{
+// @brief Low level state of a SHA-1 or SHA-2 calculation. Opaque; it is
+// created by sha_new() and released by sha_free().
+//@}
+struct sha_state;
+
+//@{
+// @brief Creates the low level state of an algorithm.
+//
+// @param nid the OpenSSL NID of the algorithm.
+// @return the state, nullptr if the algorithm has no low level engine.
+//@}
+sha_state *sha_new(int nid);
+
+//@{
+// @brief Releases a low level state.
+//
+// @param state the state, may be nullptr.
+//@}
+void sha_free(sha_state *state);
+
+//@{
+// @brief Copies a low level state of the same algorithm.
+//
+// @param dst the state to overwrite.
+// @param src the state to copy.
+//@}
+void sha_copy(sha_state &dst, const sha_state &src);
+
+//@{
+// @brief Starts, continues and ends a calculation on a low level state.
+//
+// @return true if successful.
+//@}
+bool sha_init(sha_state &state);
+bool sha_update(sha_state &state, const unsigned char *data, size_t data_len);
+bool sha_final(sha_state &state, unsigned char *digest);
+
+//@{
+// @brief Exports a low level state. The format, all numbers big endian:
+//
+//   4 bytes  "CDS" and the format version 1
+//   1 byte   algorithm: 1 SHA-1, 2 SHA-224, 3 SHA-256, 4 SHA-384,
+//            5 SHA-512
+//   1 byte   number n of buffered bytes, less than a block
+//   8 bytes  number of bytes hashed, the buffered ones included
+//   20, 32 or 64 bytes  chaining value: 5 or 8 32-bit words for SHA-1,
+//            SHA-224 and SHA-256, 8 64-bit words for SHA-384 and SHA-512
+//   n bytes  buffered bytes
+//
+// At most 205 bytes, for SHA-384 and SHA-512 with 127 buffered bytes.
+//
+// @param state the state.
+// @param buf output buffer.
+// @param buf_len length of the output buffer.
+// @return length of the exported state, 0 if the buffer is short or over
+// 2^64 - 1 bytes have been hashed.
+//@}
+size_t sha_export(const sha_state &state, unsigned char *buf, size_t buf_len);
+
+//@{
+// @brief Returns the algorithm of an exported state.
+//
+// @param buf the exported state.
+// @param buf_len length of the exported state.
+// @return the OpenSSL NID of the algorithm, NID_undef if buf is not an
+// exported state of a known version.
+//@}
+int sha_state_nid(const unsigned char *buf, size_t buf_len);
+
+//@{
+// @brief Imports a state exported by sha_export().
+//
+// @param state the state to overwrite, of the algorithm of the export.
+// @param buf the exported state.
+// @param buf_len length of the exported state.
+// @return true if successful, false if the export is malformed.
+//@}
+bool sha_import(sha_state &state, const unsigned char *buf, size_t buf_len);
+
+} // namespace openssl_digest_util
+
+} // namespace cryptcpp
+#endif
@@ -18,6 +18,14 @@ namespace cryptcpp {
 // @class openssl_digital_signature
 // @brief Implements the digital_signature interface
 // using opnssl Digital Signature Algorithm routines.
+//
+// Ed25519 and Ed448 keys sign the message itself rather than a digest of
+// it, in one pass: the digest algorithm is ignored for them, and
+// sign_digest(), verify_digest() and the streams are not supported.
+//
+// A signing and a verification context are initialized once per key and
+// digest algorithm, and copied for every message rather than initialized
+// again, so an object must not be used by several threads at once.
 //@}
 
 class openssl_digital_signature : public digital_signature {
@@ -73,6 +81,126 @@ public:
   virtual bool verify(const unsigned char *digest, size_t digest_len,
                       const unsigned char *signature, size_t sign_len) OVERRIDE;
 
+  //@{
+  // @brief Verifies the signatures of a batch of independent messages. The
+  // verifiers' cached verification contexts are initialized, if not yet,
+  // on the calling thread. The messages are split into contiguous runs,
+  // one per pool thread, and each copies the initialized context into its
+  // thread's own for every message. OpenSSL has no batch verification of
+  // EdDSA signatures, which are verified one by one like the others.
+  //
+  // @param count number of messages.
+  // @param data the messages.
+  // @param data_lens the lengths of the messages.
+  // @param signatures the digital signatures.
+  // @param sign_lens the lengths of the digital signatures.
+  // @param verifiers the openssl_digital_signature verifying each message,
+  // or nullptr.
+  // @param results output: whether each signature verification passed.
+  // @return number of signatures whose verification passed.
+  // @exception throw if a verifier has no key or is not an
+  // openssl_digital_signature.
+  //@}
+  virtual size_t verify_batch(size_t count, const unsigned char *const *data,
+                              const size_t *data_lens,
+                              const unsigned char *const *signatures,
+                              const size_t *sign_lens,
+                              const digital_signature *const *verifiers,
+                              bool *results) OVERRIDE;
+
+  //@{
+  // @brief Digitally signs a digest calculated beforehand with the private
+  // key, without hashing it again.
+  //
+  // @param digest the digest to be digitally signed.
+  // @param digest_len length of the digest.
+  // @param sign_buf output buffer where the signature is written.
+  // @param sign_buf_len maximum length of the output buffer.
+  // @return length of the digital signature.
+  // @exception throw on openssl library call error or if the digest is not
+  // as long as those of the digest algorithm.
+  //@}
+  virtual size_t sign_digest(const unsigned char *digest, size_t digest_len,
+                             unsigned char *sign_buf,
+                             size_t sign_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Verifies a digital signature against a digest calculated
+  // beforehand using the public key.
+  //
+  // @param digest the digest the signature to verify against.
+  // @param digest_len length of the digest.
+  // @param signature the digital signature.
+  // @param sign_len length of the digital signature.
+  // @return true if signature verification passed, else false.
+  // @exception throw on openssl library call error or if the digest is not
+  // as long as those of the digest algorithm.
+  //@}
+  virtual bool verify_digest(const unsigned char *digest, size_t digest_len,
+                             const unsigned char *signature,
+                             size_t sign_len) OVERRIDE;
+
+  //@{
+  // @brief Starts signing a stream. The digest context is kept across the
+  // calls and reused by the next stream.
+  //
+  // @return true if successful.
+  // @exception throw on openssl library call error.
+  //@}
+  virtual bool sign_init() OVERRIDE;
+
+  //@{
+  // @brief Adds data to the signing started by sign_init().
+  //
+  // @param data the next chunk of the message.
+  // @param data_len length of the chunk.
+  // @return true if successful.
+  // @exception throw on openssl library call error or if not signing.
+  //@}
+  virtual bool sign_update(const unsigned char *data,
+                           size_t data_len) OVERRIDE;
+
+  //@{
+  // @brief Ends the signing started by sign_init().
+  //
+  // @param sign_buf output buffer where the signature is written.
+  // @param sign_buf_len maximum length of the output buffer.
+  // @return length of the digital signature.
+  // @exception throw on openssl library call error or if not signing.
+  //@}
+  virtual size_t sign_final(unsigned char *sign_buf,
+                            size_t sign_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Starts verifying a stream.
+  //
+  // @return true if successful.
+  // @exception throw on openssl library call error.
+  //@}
+  virtual bool verify_init() OVERRIDE;
+
+  //@{
+  // @brief Adds data to the verification started by verify_init().
+  //
+  // @param data the next chunk of the message.
+  // @param data_len length of the chunk.
+  // @return true if successful.
+  // @exception throw on openssl library call error or if not verifying.
+  //@}
+  virtual bool verify_update(const unsigned char *data,
+                             size_t data_len) OVERRIDE;
+
+  //@{
+  // @brief Ends the verification started by verify_init().
+  //
+  // @param signature the digital signature.
+  // @param sign_len length of the digital signature.
+  // @return true if signature verification passed, else false.
+  // @exception throw if not verifying.
+  //@}
+  virtual bool verify_final(const unsigned char *signature,
+                            size_t sign_len) OVERRIDE;
+
   //@{
   // @brief Set digest algorithm if valid.
   //
@@ -93,12 +221,67 @@ private:
   bool update_key(EVP_PKEY *pkey);
 
   //@{
-  // @brief Common context initializer.
+  // @brief Returns the context initialized for signing or verifying with
+  // the key and digest algorithm, initializing it the first time.
+  //
+  // @param for_sign true to sign, false to verify.
+  // @return pointer to the context, owned by this object.
+  // @exception throw on openssl library call error.
+  //@}
+  EVP_MD_CTX *get_init_ctx(bool for_sign) const;
+
+  //@{
+  // @brief Common context initializer. Copies the context initialized for
+  // signing or verifying into ctx, allocating ctx the first time.
   //
+  // @param for_sign true to sign, false to verify.
+  // @param ctx the context to initialize.
+  // @return true if successful.
+  // @exception throw on openssl library call error.
+  //@}
+  bool common_ctx_init(bool for_sign, EVP_MD_CTX *&ctx);
+
+  //@{
+  // @brief Drops the initialized contexts when the key or the digest
+  // algorithm changes.
+  //@}
+  void reset_init_ctxs();
+
+  //@{
+  // @brief Common initializer of the key context of a digest calculated
+  // beforehand, for signing or verifying with the digest algorithm.
+  //
+  // @param for_sign true to sign, false to verify.
+  // @param digest_len length of the digest.
   // @return pointer to new context.
   // @exception throw on openssl library call error.
   //@}
-  EVP_MD_CTX *common_ctx_init(void);
+  EVP_PKEY_CTX *common_pkey_ctx_init(bool for_sign, size_t digest_len);
+
+  //@{
+  // @brief Returns the digest algorithm to sign with the key, nullptr for
+  // the EdDSA keys that hash the message themselves.
+  //
+  // @return the digest algorithm.
+  //@}
+  const EVP_MD *get_sign_md() const;
+
+  //@{
+  // @brief Reports an EdDSA key, which signs only whole messages.
+  //
+  // @return true if the key signs digests.
+  // @exception throw on an EdDSA key.
+  //@}
+  bool check_signs_digests() const;
+
+  //@{
+  // @brief Starts a stream on the stream context.
+  //
+  // @param for_sign true to sign, false to verify.
+  // @return true if successful.
+  // @exception throw on openssl library call error.
+  //@}
+  bool stream_init(bool for_sign);
 
   //@{
   // The digest algorithm.
@@ -109,6 +292,33 @@ private:
   // The openssl DSA key.
   //@}
   EVP_PKEY *_M_key;
+
+  //@{
+  // Contexts initialized for signing and verifying with _M_key and _M_md,
+  // nullptr until first used.
+  //@}
+  mutable EVP_MD_CTX *_M_sign_init_ctx;
+  mutable EVP_MD_CTX *_M_verify_init_ctx;
+
+  //@{
+  // The context of sign() and verify(), reused across calls.
+  //@}
+  EVP_MD_CTX *_M_op_ctx;
+
+  //@{
+  // @brief What the stream in progress does.
+  //@}
+  enum stream_state { STREAM_NONE, STREAM_SIGN, STREAM_VERIFY };
+
+  //@{
+  // The context of the streams, reused across them.
+  //@}
+  EVP_MD_CTX *_M_stream_ctx;
+
+  //@{
+  // The stream in progress on _M_stream_ctx.
+  //@}
+  stream_state _M_stream;
 };
 
 } // namespace cryptcpp
@@ -57,6 +57,21 @@ public:
   //@}
   virtual digest *create_digest() const OVERRIDE;
 
+  //@{
+  // @brief Creates a new concrete calculator of the digests of several
+  // algorithms in one pass.
+  //
+  // @return pointer to the new concrete multi digest calculator.
+  //@}
+  virtual multi_digest *create_multi_digest() const OVERRIDE;
+
+  //@{
+  // @brief Creates a new concrete MAC calculator.
+  //
+  // @return pointer to the new concrete MAC calculator.
+  //@}
+  virtual mac *create_mac() const OVERRIDE;
+
   //@{
   // @brief Creates a new concrete asymmetric key crypt.
   //
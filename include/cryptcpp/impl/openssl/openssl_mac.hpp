@@ -0,0 +1,160 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_OPENSSL_MAC_HPP__
+#define __CRYPTCPP_OPENSSL_MAC_HPP__
+
+#include <cryptcpp/mac.hpp>
+#include <openssl/opensslv.h>
+#include <openssl/ossl_typ.h>
+
+namespace cryptcpp {
+
+//@{
+// @class openssl_mac
+// @brief Implements the mac interface with the EVP_MAC routines of
+// OpenSSL 3; with older versions no algorithm is supported.
+//
+// The context is keyed once by set_key(). Every calculation then restarts
+// it without a key, which for HMAC copies back the precomputed inner hash
+// state rather than hashing the padded key again. An object must not be
+// used by several threads at once.
+//@}
+
+class openssl_mac : public mac {
+
+public:
+  //@{
+  // @brief Constructor.
+  //@}
+  openssl_mac();
+
+  //@{
+  // @brief Destructor.
+  //@}
+  virtual ~openssl_mac();
+
+  //@{
+  // @brief Sets the MAC algorithm to use, dropping the key.
+  //
+  // @param mac_algo the MAC algorithm.
+  // @return true if successful.
+  // @throw on an unsupported algorithm.
+  //@}
+  virtual bool set_mac_algorithm(mac_algorithm mac_algo) OVERRIDE;
+
+  //@{
+  // @brief Sets the key, keying the context.
+  //
+  // @param key the key.
+  // @param key_len length of the key.
+  // @return true if successful.
+  // @throw on ssl library call error or if the algorithm is not set.
+  //@}
+  virtual bool set_key(const unsigned char *key, size_t key_len) OVERRIDE;
+
+  //@{
+  // @brief Returns the length of the MAC.
+  //
+  // @return length of the MAC.
+  //@}
+  virtual size_t get_mac_len() const OVERRIDE;
+
+  //@{
+  // @brief Calculates the MAC of the given data.
+  //
+  // @param data input data whose MAC is to be calculated.
+  // @param data_len length of input data.
+  // @param mac_buf output buffer to write the MAC.
+  // @param mac_buf_len size of the output buffer.
+  // @return length of the MAC.
+  // @throw on ssl library call error.
+  //@}
+  virtual size_t calculate_mac(const unsigned char *data, size_t data_len,
+                               unsigned char *mac_buf,
+                               size_t mac_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Calculates the MACs of a batch of independent messages.
+  //
+  // @param count number of messages.
+  // @param data the messages.
+  // @param data_lens the lengths of the messages.
+  // @param mac_buf output buffer to write the MACs.
+  // @param mac_buf_len size of the output buffer.
+  // @return total length of the MACs.
+  // @throw on ssl library call error or insufficient buffer length.
+  //@}
+  virtual size_t calculate_mac_batch(size_t count,
+                                     const unsigned char *const *data,
+                                     const size_t *data_lens,
+                                     unsigned char *mac_buf,
+                                     size_t mac_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Starts an incremental MAC calculation.
+  //
+  // @return true if successful.
+  // @throw on ssl library call error, if the key is not set, or if it is a
+  // Poly1305 key already used.
+  //@}
+  virtual bool init() OVERRIDE;
+
+  //@{
+  // @brief Adds data to the MAC calculation started by init().
+  //
+  // @param data the next chunk of the input data.
+  // @param data_len length of the chunk.
+  // @return true if successful.
+  // @throw on ssl library call error.
+  //@}
+  virtual bool update(const unsigned char *data, size_t data_len) OVERRIDE;
+
+  //@{
+  // @brief Ends the MAC calculation started by init().
+  //
+  // @param mac_buf output buffer to write the MAC.
+  // @param mac_buf_len size of the output buffer.
+  // @return length of the MAC.
+  // @throw on ssl library call error or insufficient buffer length.
+  //@}
+  virtual size_t final(unsigned char *mac_buf, size_t mac_buf_len) OVERRIDE;
+
+private:
+  //@{
+  // @brief Not copyable; the MAC context is owned.
+  //@}
+  openssl_mac(const openssl_mac &) DELETED;
+  openssl_mac &operator=(const openssl_mac &) DELETED;
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  //@{
+  // @brief The MAC context of the algorithm set, nullptr if none is.
+  //@}
+  EVP_MAC_CTX *_M_ctx;
+#endif
+
+  //@{
+  // @brief Whether the context is keyed.
+  //@}
+  bool _M_keyed;
+
+  //@{
+  // @brief Whether the algorithm is a one-time authenticator, whose key
+  // serves a single calculation.
+  //@}
+  bool _M_one_time;
+
+  //@{
+  // @brief Whether a calculation was started since the key was set.
+  //@}
+  bool _M_key_used;
+};
+
+} // namespace cryptcpp
+#endif
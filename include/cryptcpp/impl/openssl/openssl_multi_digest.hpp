@@ -0,0 +1,139 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_OPENSSL_MULTI_DIGEST_HPP__
+#define __CRYPTCPP_OPENSSL_MULTI_DIGEST_HPP__
+
+#include <cryptcpp/multi_digest.hpp>
+#include <vector>
+
+namespace cryptcpp {
+
+class openssl_digest;
+
+//@{
+// @class openssl_multi_digest
+// @brief Implements the multi_digest interface with an openssl_digest per
+// algorithm.
+//
+// The input is fed to the digests in chunks small enough to stay in the
+// L1 cache, each chunk to all of them before the next one, so the data is
+// read from memory once however many algorithms there are.
+//@}
+
+class openssl_multi_digest : public multi_digest {
+
+public:
+  //@{
+  // @brief Constructor.
+  //@}
+  openssl_multi_digest();
+
+  //@{
+  // @brief Destructor.
+  //@}
+  virtual ~openssl_multi_digest();
+
+  //@{
+  // @brief Sets the digest algorithms, replacing any set before. On error
+  // the previous ones are kept.
+  //
+  // @param digest_algos the digest algorithms.
+  // @param num_algos number of digest algorithms.
+  // @return true if successful.
+  // @throw on an unsupported algorithm.
+  //@}
+  virtual bool
+  set_digest_algorithms(const digest::digest_algorithm *digest_algos,
+                        size_t num_algos) OVERRIDE;
+
+  //@{
+  // @brief Returns the number of digest algorithms.
+  //
+  // @return number of digest algorithms.
+  //@}
+  virtual size_t get_num_digests() const OVERRIDE;
+
+  //@{
+  // @brief Returns the length of the digest of an algorithm.
+  //
+  // @param index index of the algorithm.
+  // @return length of its digest.
+  //@}
+  virtual size_t get_digest_len(size_t index) const OVERRIDE;
+
+  //@{
+  // @brief Returns the length of all the digests together.
+  //
+  // @return sum of the digest lengths.
+  //@}
+  virtual size_t get_digests_len() const OVERRIDE;
+
+  //@{
+  // @brief Calculates the digests of the given data.
+  //
+  // @param data input data whose digests are to be calculated.
+  // @param data_len length of input data.
+  // @param digest_buf output buffer to write the digests.
+  // @param digest_buf_len size of the output buffer.
+  // @return length of the digests.
+  // @throw on ssl library call error.
+  //@}
+  virtual size_t calculate_digests(const unsigned char *data, size_t data_len,
+                                   unsigned char *digest_buf,
+                                   size_t digest_buf_len) OVERRIDE;
+
+  //@{
+  // @brief Starts an incremental calculation of the digests.
+  //
+  // @return true if successful.
+  // @throw on ssl library call error or if no algorithm is set.
+  //@}
+  virtual bool init() OVERRIDE;
+
+  //@{
+  // @brief Adds data to the calculation started by init().
+  //
+  // @param data the next chunk of the input data.
+  // @param data_len length of the chunk.
+  // @return true if successful.
+  // @throw on ssl library call error.
+  //@}
+  virtual bool update(const unsigned char *data, size_t data_len) OVERRIDE;
+
+  //@{
+  // @brief Ends the calculation started by init().
+  //
+  // @param digest_buf output buffer to write the digests.
+  // @param digest_buf_len size of the output buffer.
+  // @return length of the digests.
+  // @throw on ssl library call error or insufficient buffer length.
+  //@}
+  virtual size_t final(unsigned char *digest_buf,
+                       size_t digest_buf_len) OVERRIDE;
+
+private:
+  //@{
+  // @brief Not copyable; the digests are owned.
+  //@}
+  openssl_multi_digest(const openssl_multi_digest &) DELETED;
+  openssl_multi_digest &operator=(const openssl_multi_digest &) DELETED;
+
+  //@{
+  // @brief Deletes the digests.
+  //@}
+  static void free_digests(std::vector<openssl_digest *> &digests);
+
+  //@{
+  // @brief A digest per algorithm, in order.
+  //@}
+  std::vector<openssl_digest *> _M_digests;
+};
+
+} // namespace cryptcpp
+#endif
@@ -0,0 +1,62 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_OPENSSL_THREAD_UTIL_HPP__
+#define __CRYPTCPP_OPENSSL_THREAD_UTIL_HPP__
+
+#include <cryptcpp/cryptcpp_cpp_std.hpp>
+#include <openssl/evp.h>
+#include <cstdlib>
+
+namespace cryptcpp {
+
+//@{
+// @namespace openssl_thread_util
+// @brief Provides a pool of worker threads to spread independent tasks
+// over. The workers are started on first use and kept for the life of the
+// process, so that each call costs a wakeup rather than a thread start.
+// POSIX threads are used before C++11 and std::thread afterwards.
+//@}
+
+namespace openssl_thread_util {
+
+//@{
+// @brief A task run by run_tasks().
+//
+// @param ctx context shared by all the tasks.
+// @param task index of the task to run.
+//@}
+typedef void (*task_func)(void *ctx, size_t task);
+
+//@{
+// @brief Runs tasks 0 to num_tasks - 1 on up to num_threads threads,
+// the calling thread and pool threads, and returns once all of them are
+// done. The pool grows to num_threads - 1 threads on demand; tasks the
+// pool cannot take run on the calling thread.
+//
+// @param func the task function.
+// @param ctx context passed to every task.
+// @param num_tasks number of tasks.
+// @param num_threads maximum number of threads to use.
+//@}
+void run_tasks(task_func func, void *ctx, size_t num_tasks,
+               size_t num_threads);
+
+//@{
+// @brief Returns a digest context owned by the calling thread, created on
+// first use and freed when the thread exits. Pool threads thus keep theirs
+// from one run_tasks() call to the next.
+//
+// @return the context, nullptr if it cannot be created.
+//@}
+EVP_MD_CTX *get_thread_md_ctx();
+
+} // namespace openssl_thread_util
+
+} // namespace cryptcpp
+#endif
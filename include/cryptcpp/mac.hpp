@@ -0,0 +1,138 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_MAC_HPP__
+#define __CRYPTCPP_MAC_HPP__
+
+#include "cryptcpp_cpp_std.hpp"
+#include <cstdlib>
+
+namespace cryptcpp {
+
+//@{
+// @class mac
+// Interface for keyed message authentication code calculation.
+//
+// The key is set once and the state derived from it kept, so every
+// message costs only the hashing of the message itself.
+//@}
+
+class mac {
+
+public:
+  //@{
+  // @brief Types of MAC algorithms. Any digest may follow "HMAC-", as in
+  // "HMAC-SHA256".
+  //@}
+  typedef const char *mac_algorithm;
+  static inline mac_algorithm MAC_HMAC_SHA1() { return "HMAC-SHA1"; }
+  static inline mac_algorithm MAC_HMAC_SHA256() { return "HMAC-SHA256"; }
+  static inline mac_algorithm MAC_HMAC_SHA384() { return "HMAC-SHA384"; }
+  static inline mac_algorithm MAC_HMAC_SHA512() { return "HMAC-SHA512"; }
+  static inline mac_algorithm MAC_HMAC_SHA3_256() { return "HMAC-SHA3-256"; }
+  static inline mac_algorithm MAC_HMAC_SHA3_512() { return "HMAC-SHA3-512"; }
+  static inline mac_algorithm MAC_KMAC128() { return "KMAC128"; }
+  static inline mac_algorithm MAC_KMAC256() { return "KMAC256"; }
+
+  //@{
+  // @brief Poly1305, a one-time authenticator: its 32 byte key must be set
+  // anew for every message.
+  //@}
+  static inline mac_algorithm MAC_POLY1305() { return "POLY1305"; }
+
+  //@{
+  // Polymorphic base class.
+  //@}
+  virtual ~mac() DFLTDSTR;
+
+  //@{
+  // @brief Sets the MAC algorithm to use. The key must be set afterwards.
+  //
+  // @param mac_algo the MAC algorithm.
+  // @return true if successful.
+  //@}
+  virtual bool set_mac_algorithm(mac_algorithm mac_algo) = 0;
+
+  //@{
+  // @brief Sets the key and derives the state of the algorithm from it,
+  // such as the inner and outer hash states of HMAC, for all the messages
+  // that follow.
+  //
+  // @param key the key.
+  // @param key_len length of the key.
+  // @return true if successful.
+  //@}
+  virtual bool set_key(const unsigned char *key, size_t key_len) = 0;
+
+  //@{
+  // @brief Returns the length of the MAC.
+  //
+  // @return length of the MAC, 0 if no algorithm is set.
+  //@}
+  virtual size_t get_mac_len() const = 0;
+
+  //@{
+  // @brief Calculates the MAC of the given data.
+  //
+  // @param data input data whose MAC is to be calculated.
+  // @param data_len length of input data.
+  // @param mac_buf output buffer to write the MAC.
+  // @param mac_buf_len size of the output buffer, at least get_mac_len().
+  // @return length of the MAC, 0 on error.
+  //@}
+  virtual size_t calculate_mac(const unsigned char *data, size_t data_len,
+                               unsigned char *mac_buf, size_t mac_buf_len) = 0;
+
+  //@{
+  // @brief Calculates the MACs of a batch of independent messages with the
+  // same key, packed back to back, MAC i at offset i * get_mac_len().
+  // Not supported by MAC_POLY1305(), whose key serves a single message.
+  //
+  // @param count number of messages.
+  // @param data the messages.
+  // @param data_lens the lengths of the messages.
+  // @param mac_buf output buffer to write the MACs.
+  // @param mac_buf_len size of the output buffer, at least count *
+  // get_mac_len().
+  // @return total length of the MACs, 0 on error.
+  //@}
+  virtual size_t calculate_mac_batch(size_t count,
+                                     const unsigned char *const *data,
+                                     const size_t *data_lens,
+                                     unsigned char *mac_buf,
+                                     size_t mac_buf_len) = 0;
+
+  //@{
+  // @brief Starts an incremental MAC calculation with the key set,
+  // discarding any calculation in progress.
+  //
+  // @return true if successful.
+  //@}
+  virtual bool init() = 0;
+
+  //@{
+  // @brief Adds data to the MAC calculation started by init().
+  //
+  // @param data the next chunk of the input data.
+  // @param data_len length of the chunk.
+  // @return true if successful.
+  //@}
+  virtual bool update(const unsigned char *data, size_t data_len) = 0;
+
+  //@{
+  // @brief Ends the MAC calculation started by init().
+  //
+  // @param mac_buf output buffer to write the MAC.
+  // @param mac_buf_len size of the output buffer, at least get_mac_len().
+  // @return length of the MAC, 0 on error.
+  //@}
+  virtual size_t final(unsigned char *mac_buf, size_t mac_buf_len) = 0;
+};
+
+} // namespace cryptcpp
+#endif
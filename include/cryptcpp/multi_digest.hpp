@@ -0,0 +1,111 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#ifndef __CRYPTCPP_MULTI_DIGEST_HPP__
+#define __CRYPTCPP_MULTI_DIGEST_HPP__
+
+#include "cryptcpp_cpp_std.hpp"
+#include "digest.hpp"
+#include <cstdlib>
+
+namespace cryptcpp {
+
+//@{
+// @class multi_digest
+// Interface for calculating the digests of several algorithms of the same
+// data in a single pass over it, such as the MD5, SHA-1 and SHA-256 of a
+// payload. The digests are written one after the other, in the order of
+// the algorithms.
+//@}
+
+class multi_digest {
+
+public:
+  //@{
+  // Polymorphic base class.
+  //@}
+  virtual ~multi_digest() DFLTDSTR;
+
+  //@{
+  // @brief Sets the digest algorithms, replacing any set before.
+  //
+  // @param digest_algos the digest algorithms.
+  // @param num_algos number of digest algorithms.
+  // @return true if successful.
+  //@}
+  virtual bool
+  set_digest_algorithms(const digest::digest_algorithm *digest_algos,
+                        size_t num_algos) = 0;
+
+  //@{
+  // @brief Returns the number of digest algorithms.
+  //
+  // @return number of digest algorithms.
+  //@}
+  virtual size_t get_num_digests() const = 0;
+
+  //@{
+  // @brief Returns the length of the digest of an algorithm.
+  //
+  // @param index index of the algorithm.
+  // @return length of its digest, 0 if there is no such algorithm.
+  //@}
+  virtual size_t get_digest_len(size_t index) const = 0;
+
+  //@{
+  // @brief Returns the length of all the digests together.
+  //
+  // @return sum of the digest lengths.
+  //@}
+  virtual size_t get_digests_len() const = 0;
+
+  //@{
+  // @brief Calculates the digests of the given data.
+  //
+  // @param data input data whose digests are to be calculated.
+  // @param data_len length of input data.
+  // @param digest_buf output buffer to write the digests, one after the
+  // other.
+  // @param digest_buf_len size of the output buffer, at least
+  // get_digests_len().
+  // @return length of the digests.
+  //@}
+  virtual size_t calculate_digests(const unsigned char *data, size_t data_len,
+                                   unsigned char *digest_buf,
+                                   size_t digest_buf_len) = 0;
+
+  //@{
+  // @brief Starts an incremental calculation of the digests.
+  //
+  // @return true if successful.
+  //@}
+  virtual bool init() = 0;
+
+  //@{
+  // @brief Adds data to the calculation started by init().
+  //
+  // @param data the next chunk of the input data.
+  // @param data_len length of the chunk.
+  // @return true if successful.
+  //@}
+  virtual bool update(const unsigned char *data, size_t data_len) = 0;
+
+  //@{
+  // @brief Ends the calculation started by init().
+  //
+  // @param digest_buf output buffer to write the digests, one after the
+  // other.
+  // @param digest_buf_len size of the output buffer, at least
+  // get_digests_len().
+  // @return length of the digests, 0 on error.
+  //@}
+  virtual size_t final(unsigned char *digest_buf, size_t digest_buf_len) = 0;
+};
+
+} // namespace cryptcpp
+#endif
@@ -0,0 +1,159 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cryptcpp/impl/openssl/openssl_codec_base32.hpp>
+#include <cryptcpp/impl/openssl/openssl_codec_util.hpp>
+#include <cryptcpp/impl/openssl/openssl_exception.hpp>
+
+namespace cryptcpp {
+
+bool openssl_codec_base32::use_hex_alphabet() const {
+  return (_M_codec_algo == CODEC_BASE32HEX);
+}
+
+size_t openssl_codec_base32::get_max_encoded_buf_len(size_t raw_len) const {
+  return (openssl_codec_util::base32_encoded_len(raw_len) + 1);
+}
+
+size_t openssl_codec_base32::get_max_decoded_buf_len(size_t enc_len) const {
+  return ((enc_len * 5 / 8) + 1);
+}
+
+ssize_t openssl_codec_base32::encode(const char *raw_buf, size_t raw_len,
+                                     char *enc_buf, size_t enc_buf_len) {
+  const size_t enc_len = openssl_codec_util::base32_encoded_len(raw_len);
+  if (enc_buf_len < enc_len) {
+    report_exception(openssl_exception(
+        "openssl_codec_base32::encode: Insufficient buffer length"));
+    return -1;
+  }
+
+  openssl_codec_util::base32_encode(
+      reinterpret_cast<const unsigned char *>(raw_buf), raw_len, enc_buf,
+      use_hex_alphabet(), _M_num_threads);
+  if (enc_len < enc_buf_len) {
+    enc_buf[enc_len] = '\0';
+  }
+
+  return enc_len;
+}
+
+ssize_t openssl_codec_base32::decode(const char *enc_buf, size_t enc_len,
+                                     char *dec_buf, size_t dec_buf_len) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base32_decode(
+      enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, use_hex_alphabet(), status);
+
+  openssl_codec_util::report_decode_status("openssl_codec_base32::decode",
+                                           status);
+  return dec_len;
+}
+
+ssize_t openssl_codec_base32::decode_strict(const char *enc_buf,
+                                            size_t enc_len, char *dec_buf,
+                                            size_t dec_buf_len,
+                                            decode_error &error,
+                                            size_t &error_offset) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base32_decode_strict(
+      enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, use_hex_alphabet(), status, error_offset);
+
+  error = openssl_codec_util::get_decode_error(status);
+  return dec_len;
+}
+
+ssize_t openssl_codec_base32::encode_batch(size_t count,
+                                           const char *const *raw_bufs,
+                                           const size_t *raw_lens,
+                                           char *enc_buf, size_t enc_buf_len,
+                                           size_t *enc_offsets) {
+  size_t enc_len = 0;
+  for (size_t i = 0; i < count; ++i) {
+    enc_len += openssl_codec_util::base32_encoded_len(raw_lens[i]);
+  }
+  if (enc_buf_len < enc_len) {
+    report_exception(openssl_exception(
+        "openssl_codec_base32::encode_batch: Insufficient buffer length"));
+    return -1;
+  }
+
+  return openssl_codec_util::base32_encode_batch(
+      count, raw_bufs, raw_lens, enc_buf, enc_offsets, use_hex_alphabet());
+}
+
+ssize_t openssl_codec_base32::decode_batch(size_t count,
+                                           const char *const *enc_bufs,
+                                           const size_t *enc_lens,
+                                           char *dec_buf, size_t dec_buf_len,
+                                           size_t *dec_offsets) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base32_decode_batch(
+      count, enc_bufs, enc_lens, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, dec_offsets, use_hex_alphabet(), status);
+
+  openssl_codec_util::report_decode_status("openssl_codec_base32::decode_batch",
+                                           status);
+  return dec_len;
+}
+
+ssize_t openssl_codec_base32::encode_update(const char *raw_buf, size_t raw_len,
+                                            char *enc_buf,
+                                            size_t enc_buf_len) {
+  if (enc_buf_len <
+      openssl_codec_util::base32_encode_update_len(_M_encoder, raw_len)) {
+    report_exception(openssl_exception(
+        "openssl_codec_base32::encode_update: Insufficient buffer length"));
+    return -1;
+  }
+
+  return openssl_codec_util::base32_encode_update(
+      _M_encoder, reinterpret_cast<const unsigned char *>(raw_buf), raw_len,
+      enc_buf, use_hex_alphabet());
+}
+
+ssize_t openssl_codec_base32::encode_final(char *enc_buf, size_t enc_buf_len) {
+  if (enc_buf_len < openssl_codec_util::base32_encode_final_len(_M_encoder)) {
+    report_exception(openssl_exception(
+        "openssl_codec_base32::encode_final: Insufficient buffer length"));
+    return -1;
+  }
+
+  return openssl_codec_util::base32_encode_final(_M_encoder, enc_buf,
+                                                 use_hex_alphabet());
+}
+
+ssize_t openssl_codec_base32::decode_update(const char *enc_buf,
+                                            size_t enc_len, char *dec_buf,
+                                            size_t dec_buf_len) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base32_decode_update(
+      _M_decoder, enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, use_hex_alphabet(), status);
+
+  if (dec_len < 0) {
+    _M_decoder = openssl_codec_util::base32_decoder();
+    openssl_codec_util::report_decode_status(
+        "openssl_codec_base32::decode_update", status);
+  }
+  return dec_len;
+}
+
+ssize_t openssl_codec_base32::decode_final(char *dec_buf, size_t dec_buf_len) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base32_decode_final(
+      _M_decoder, reinterpret_cast<unsigned char *>(dec_buf), dec_buf_len,
+      status);
+
+  openssl_codec_util::report_decode_status("openssl_codec_base32::decode_final",
+                                           status);
+  return dec_len;
+}
+
+} // namespace cryptcpp
@@ -0,0 +1,130 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cryptcpp/impl/openssl/openssl_codec_base58.hpp>
+#include <cryptcpp/impl/openssl/openssl_codec_util.hpp>
+#include <cryptcpp/impl/openssl/openssl_exception.hpp>
+
+namespace cryptcpp {
+
+size_t openssl_codec_base58::get_max_encoded_buf_len(size_t raw_len) const {
+  return (openssl_codec_util::base58_max_encoded_len(raw_len) + 1);
+}
+
+size_t openssl_codec_base58::get_max_decoded_buf_len(size_t enc_len) const {
+  // A digit never carries more than a byte, a leading '1' exactly one.
+  return (enc_len + 1);
+}
+
+ssize_t openssl_codec_base58::encode(const char *raw_buf, size_t raw_len,
+                                     char *enc_buf, size_t enc_buf_len) {
+  const ssize_t enc_len = openssl_codec_util::base58_encode(
+      reinterpret_cast<const unsigned char *>(raw_buf), raw_len, enc_buf,
+      enc_buf_len);
+  if (enc_len < 0) {
+    report_exception(openssl_exception(
+        "openssl_codec_base58::encode: Insufficient buffer length"));
+    return -1;
+  }
+
+  if (static_cast<size_t>(enc_len) < enc_buf_len) {
+    enc_buf[enc_len] = '\0';
+  }
+  return enc_len;
+}
+
+ssize_t openssl_codec_base58::decode(const char *enc_buf, size_t enc_len,
+                                     char *dec_buf, size_t dec_buf_len) {
+  openssl_codec_util::decode_status status;
+  size_t error_offset;
+  const ssize_t dec_len = openssl_codec_util::base58_decode(
+      enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, status, error_offset);
+
+  openssl_codec_util::report_decode_status("openssl_codec_base58::decode",
+                                           status);
+  return dec_len;
+}
+
+ssize_t openssl_codec_base58::decode_strict(const char *enc_buf,
+                                            size_t enc_len, char *dec_buf,
+                                            size_t dec_buf_len,
+                                            decode_error &error,
+                                            size_t &error_offset) {
+  // Base-58 has neither padding nor whitespace to be lenient about.
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base58_decode(
+      enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, status, error_offset);
+
+  error = openssl_codec_util::get_decode_error(status);
+  return dec_len;
+}
+
+ssize_t openssl_codec_base58::encode_batch(size_t count,
+                                           const char *const *raw_bufs,
+                                           const size_t *raw_lens,
+                                           char *enc_buf, size_t enc_buf_len,
+                                           size_t *enc_offsets) {
+  const ssize_t enc_len = openssl_codec_util::base58_encode_batch(
+      count, raw_bufs, raw_lens, enc_buf, enc_buf_len, enc_offsets);
+  if (enc_len < 0) {
+    report_exception(openssl_exception(
+        "openssl_codec_base58::encode_batch: Insufficient buffer length"));
+  }
+  return enc_len;
+}
+
+ssize_t openssl_codec_base58::decode_batch(size_t count,
+                                           const char *const *enc_bufs,
+                                           const size_t *enc_lens,
+                                           char *dec_buf, size_t dec_buf_len,
+                                           size_t *dec_offsets) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base58_decode_batch(
+      count, enc_bufs, enc_lens, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, dec_offsets, status);
+
+  openssl_codec_util::report_decode_status("openssl_codec_base58::decode_batch",
+                                           status);
+  return dec_len;
+}
+
+ssize_t openssl_codec_base58::encode_update(const char * /* raw_buf */,
+                                            size_t /* raw_len */,
+                                            char * /* enc_buf */,
+                                            size_t /* enc_buf_len */) {
+  report_exception(openssl_exception(
+      "openssl_codec_base58::encode_update: Streaming not supported"));
+  return -1;
+}
+
+ssize_t openssl_codec_base58::encode_final(char * /* enc_buf */,
+                                           size_t /* enc_buf_len */) {
+  report_exception(openssl_exception(
+      "openssl_codec_base58::encode_final: Streaming not supported"));
+  return -1;
+}
+
+ssize_t openssl_codec_base58::decode_update(const char * /* enc_buf */,
+                                            size_t /* enc_len */,
+                                            char * /* dec_buf */,
+                                            size_t /* dec_buf_len */) {
+  report_exception(openssl_exception(
+      "openssl_codec_base58::decode_update: Streaming not supported"));
+  return -1;
+}
+
+ssize_t openssl_codec_base58::decode_final(char * /* dec_buf */,
+                                           size_t /* dec_buf_len */) {
+  report_exception(openssl_exception(
+      "openssl_codec_base58::decode_final: Streaming not supported"));
+  return -1;
+}
+
+} // namespace cryptcpp
@@ -6,20 +6,33 @@
 // in the file LICENSE in the source distribution.
 //
 
-#include <cryptcpp/cryptcpp_util.hpp>
 #include <cryptcpp/impl/openssl/openssl_codec_base64.hpp>
+#include <cryptcpp/impl/openssl/openssl_codec_util.hpp>
 #include <cryptcpp/impl/openssl/openssl_exception.hpp>
 
-#include <openssl/bio.h>
-#include <openssl/evp.h>
-
-#include <algorithm>
-#include <cstring>
-
 namespace cryptcpp {
 
+int openssl_codec_base64::get_format() const {
+  switch (_M_codec_algo) {
+  case CODEC_BASE64_NL:
+    return openssl_codec_util::BASE64_WRAP_LINES;
+  case CODEC_BASE64URL:
+    return (openssl_codec_util::BASE64_URL | openssl_codec_util::BASE64_NO_PAD);
+  case CODEC_BASE64_NOPAD:
+    return openssl_codec_util::BASE64_NO_PAD;
+  default:
+    return 0;
+  }
+}
+
 size_t openssl_codec_base64::get_max_encoded_buf_len(size_t raw_len) const {
-  return ((((4 * raw_len / 3) + 3) & ~3) + 1);
+  const int format = get_format();
+  // Without padding a group is only as long as its data, so up to two
+  // bytes held back by encode_update() may complete in the next chunk.
+  if (format & openssl_codec_util::BASE64_NO_PAD) {
+    raw_len += 2;
+  }
+  return (openssl_codec_util::base64_encoded_len(raw_len, format) + 1);
 }
 
 size_t openssl_codec_base64::get_max_decoded_buf_len(size_t enc_len) const {
@@ -28,74 +41,141 @@ size_t openssl_codec_base64::get_max_decoded_buf_len(size_t enc_len) const {
 
 ssize_t openssl_codec_base64::encode(const char *raw_buf, size_t raw_len,
                                      char *enc_buf, size_t enc_buf_len) {
-
-  // Create a BIO base64 filter.
-  // Ensure exception safe cleanup.
-  cryptcpp_unique_ptr<BIO> b64(BIO_new(BIO_f_base64()), BIO_free_all);
-  if (!b64) {
-    report_exception(openssl_exception("BIO_new(BIO_f_base64()):"));
+  const int format = get_format();
+  const size_t enc_len =
+      openssl_codec_util::base64_encoded_len(raw_len, format);
+  if (enc_buf_len < enc_len) {
+    report_exception(openssl_exception(
+        "openssl_codec_base64::encode: Insufficient buffer length"));
     return -1;
   }
 
-  BIO *b64_chain = b64.get();
-
-  if (_M_codec_algo != CODEC_BASE64_NL) {
-    BIO_set_flags(b64_chain, BIO_FLAGS_BASE64_NO_NL);
+  // Encode straight into the output buffer.
+  openssl_codec_util::base64_encode(
+      reinterpret_cast<const unsigned char *>(raw_buf), raw_len, enc_buf,
+      format, _M_num_threads);
+  if (enc_len < enc_buf_len) {
+    enc_buf[enc_len] = '\0';
   }
 
-  // Append a BIO memory buffer to the base64 filter.
-  BIO *bmem = BIO_new(BIO_s_mem());
-  if (!bmem) {
-    report_exception(openssl_exception("BIO_new(BIO_s_mem()):"));
-    return -1;
-  }
-  b64_chain = BIO_push(b64_chain, bmem);
+  return enc_len;
+}
+
+ssize_t openssl_codec_base64::decode(const char *enc_buf, size_t enc_len,
+                                     char *dec_buf, size_t dec_buf_len) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base64_decode(
+      enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, get_format(), status);
+
+  openssl_codec_util::report_decode_status("openssl_codec_base64::decode",
+                                           status);
+  return dec_len;
+}
 
-  // Write the input data into the BIO chain.
-  BIO_write(b64_chain, raw_buf, raw_len);
-  if (1 != BIO_flush(b64_chain)) {
-    report_exception(openssl_exception("BIO_flush"));
+ssize_t openssl_codec_base64::decode_strict(const char *enc_buf,
+                                            size_t enc_len, char *dec_buf,
+                                            size_t dec_buf_len,
+                                            decode_error &error,
+                                            size_t &error_offset) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base64_decode_strict(
+      enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, get_format(), status, error_offset);
+
+  error = openssl_codec_util::get_decode_error(status);
+  return dec_len;
+}
+
+ssize_t openssl_codec_base64::encode_batch(size_t count,
+                                           const char *const *raw_bufs,
+                                           const size_t *raw_lens,
+                                           char *enc_buf, size_t enc_buf_len,
+                                           size_t *enc_offsets) {
+  const int format = get_format();
+  size_t enc_len = 0;
+  for (size_t i = 0; i < count; ++i) {
+    enc_len += openssl_codec_util::base64_encoded_len(raw_lens[i], format);
+  }
+  if (enc_buf_len < enc_len) {
+    report_exception(openssl_exception(
+        "openssl_codec_base64::encode_batch: Insufficient buffer length"));
     return -1;
   }
 
-  // Read the encoded data back from the BIO chain.
-  char *dt = nullptr;
-  const ssize_t enc_len = BIO_get_mem_data(b64_chain, &dt);
-  const ssize_t out_len = std::min(enc_len, static_cast<ssize_t>(enc_buf_len));
-  memcpy(enc_buf, dt, out_len);
-  if (static_cast<size_t>(out_len) < enc_buf_len) {
-    enc_buf[out_len] = '\0';
-  }
+  return openssl_codec_util::base64_encode_batch(
+      count, raw_bufs, raw_lens, enc_buf, enc_offsets, format);
+}
 
-  return out_len;
+ssize_t openssl_codec_base64::decode_batch(size_t count,
+                                           const char *const *enc_bufs,
+                                           const size_t *enc_lens,
+                                           char *dec_buf, size_t dec_buf_len,
+                                           size_t *dec_offsets) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base64_decode_batch(
+      count, enc_bufs, enc_lens, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, dec_offsets, get_format(), status);
+
+  openssl_codec_util::report_decode_status("openssl_codec_base64::decode_batch",
+                                           status);
+  return dec_len;
 }
 
-ssize_t openssl_codec_base64::decode(const char *enc_buf, size_t enc_len,
-                                     char *dec_buf, size_t dec_buf_len) {
-  // Create a BIO base64 filter.
-  // Ensure exception safe cleanup.
-  cryptcpp_unique_ptr<BIO> b64(BIO_new(BIO_f_base64()), BIO_free_all);
-  if (!b64) {
-    report_exception(openssl_exception("BIO_new(BIO_f_base64()):"));
+ssize_t openssl_codec_base64::encode_update(const char *raw_buf, size_t raw_len,
+                                            char *enc_buf,
+                                            size_t enc_buf_len) {
+  const int format = get_format();
+  if (enc_buf_len < openssl_codec_util::base64_encode_update_len(
+                        _M_encoder, raw_len, format)) {
+    report_exception(openssl_exception(
+        "openssl_codec_base64::encode_update: Insufficient buffer length"));
     return -1;
   }
 
-  BIO *b64_chain = b64.get();
+  return openssl_codec_util::base64_encode_update(
+      _M_encoder, reinterpret_cast<const unsigned char *>(raw_buf), raw_len,
+      enc_buf, format);
+}
 
-  if (_M_codec_algo != CODEC_BASE64_NL) {
-    BIO_set_flags(b64_chain, BIO_FLAGS_BASE64_NO_NL);
+ssize_t openssl_codec_base64::encode_final(char *enc_buf, size_t enc_buf_len) {
+  const int format = get_format();
+  if (enc_buf_len <
+      openssl_codec_util::base64_encode_final_len(_M_encoder, format)) {
+    report_exception(openssl_exception(
+        "openssl_codec_base64::encode_final: Insufficient buffer length"));
+    return -1;
   }
 
-  // Append a BIO memory buffer containing the input to the base64 filter.
-  BIO *bmem = BIO_new_mem_buf(enc_buf, enc_len);
-  if (!bmem) {
-    report_exception(openssl_exception("BIO_new(BIO_s_mem()):"));
-    return -1;
+  return openssl_codec_util::base64_encode_final(_M_encoder, enc_buf,
+                                                 format);
+}
+
+ssize_t openssl_codec_base64::decode_update(const char *enc_buf,
+                                            size_t enc_len, char *dec_buf,
+                                            size_t dec_buf_len) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base64_decode_update(
+      _M_decoder, enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, get_format(), status);
+
+  if (dec_len < 0) {
+    _M_decoder = openssl_codec_util::base64_decoder();
+    openssl_codec_util::report_decode_status(
+        "openssl_codec_base64::decode_update", status);
   }
-  b64_chain = BIO_push(b64_chain, bmem);
+  return dec_len;
+}
+
+ssize_t openssl_codec_base64::decode_final(char *dec_buf, size_t dec_buf_len) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::base64_decode_final(
+      _M_decoder, reinterpret_cast<unsigned char *>(dec_buf), dec_buf_len,
+      status);
 
-  // Read back decoded data through the chain.
-  return BIO_read(b64_chain, dec_buf, dec_buf_len);
+  openssl_codec_util::report_decode_status("openssl_codec_base64::decode_final",
+                                           status);
+  return dec_len;
 }
 
 } // namespace cryptcpp
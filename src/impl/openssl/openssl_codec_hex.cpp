@@ -6,15 +6,10 @@
 // in the file LICENSE in the source distribution.
 //
 
-#include <cryptcpp/cryptcpp_util.hpp>
 #include <cryptcpp/impl/openssl/openssl_codec_hex.hpp>
+#include <cryptcpp/impl/openssl/openssl_codec_util.hpp>
 #include <cryptcpp/impl/openssl/openssl_exception.hpp>
 
-#include <openssl/bn.h>
-
-#include <algorithm>
-#include <cstring>
-
 namespace cryptcpp {
 
 size_t openssl_codec_hex::get_max_encoded_buf_len(size_t raw_len) const {
@@ -27,57 +22,127 @@ size_t openssl_codec_hex::get_max_decoded_buf_len(size_t enc_len) const {
 
 ssize_t openssl_codec_hex::encode(const char *raw_buf, size_t raw_len,
                                   char *enc_buf, size_t enc_buf_len) {
-  // Convert input data to big number.
-  // Ensure exception safe cleanup.
-  cryptcpp_unique_ptr<BIGNUM> big_num(
-      BN_bin2bn(reinterpret_cast<const unsigned char *>(raw_buf), raw_len,
-                nullptr),
-      BN_free);
-  if (!big_num) {
-    report_exception(openssl_exception("BN_bin2bn:"));
+  const size_t enc_len = raw_len * 2;
+  if (enc_buf_len < enc_len) {
+    report_exception(openssl_exception(
+        "openssl_codec_hex::encode: Insufficient buffer length"));
     return -1;
   }
 
-  // Convert big number to hex string.
-  char *hex_rep = BN_bn2hex(big_num.get());
-  if (!hex_rep) {
-    report_exception(openssl_exception("BN_bn2hex:"));
-    return -1;
+  // Every byte maps to two digits; leading zero bytes are kept.
+  openssl_codec_util::hex_encode(
+      reinterpret_cast<const unsigned char *>(raw_buf), raw_len, enc_buf,
+      _M_codec_algo != CODEC_HEX_LOWER, _M_num_threads);
+  if (enc_len < enc_buf_len) {
+    enc_buf[enc_len] = '\0';
   }
 
-  const size_t out_len = std::min(enc_buf_len, strlen(hex_rep));
-  memcpy(enc_buf, hex_rep, out_len);
-  if (out_len < enc_buf_len) {
-    enc_buf[out_len] = '\0';
-  }
+  return enc_len;
+}
 
-  OPENSSL_free(hex_rep);
+ssize_t openssl_codec_hex::decode(const char *enc_buf, size_t enc_len,
+                                  char *dec_buf, size_t dec_buf_len) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::hex_decode(
+      enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, status, _M_num_threads);
 
-  return out_len;
+  openssl_codec_util::report_decode_status("openssl_codec_hex::decode", status);
+  return dec_len;
 }
 
-ssize_t openssl_codec_hex::decode(const char *enc_buf, size_t /*enc_len*/,
-                                  char *dec_buf, size_t dec_buf_len) {
-  BIGNUM *big_num_ptr = nullptr;
+ssize_t openssl_codec_hex::decode_strict(const char *enc_buf, size_t enc_len,
+                                         char *dec_buf, size_t dec_buf_len,
+                                         decode_error &error,
+                                         size_t &error_offset) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::hex_decode_strict(
+      enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, status, error_offset, _M_num_threads);
+
+  error = openssl_codec_util::get_decode_error(status);
+  return dec_len;
+}
 
-  // Convert hex string to big number.
-  if (BN_hex2bn(&big_num_ptr, enc_buf) == 0) {
-    report_exception(openssl_exception("BN_hex2bn:"));
+ssize_t openssl_codec_hex::encode_batch(size_t count,
+                                        const char *const *raw_bufs,
+                                        const size_t *raw_lens, char *enc_buf,
+                                        size_t enc_buf_len,
+                                        size_t *enc_offsets) {
+  size_t enc_len = 0;
+  for (size_t i = 0; i < count; ++i) {
+    enc_len += raw_lens[i] * 2;
+  }
+  if (enc_buf_len < enc_len) {
+    report_exception(openssl_exception(
+        "openssl_codec_hex::encode_batch: Insufficient buffer length"));
     return -1;
   }
 
-  // Ensure exception safe cleanup.
-  cryptcpp_unique_ptr<BIGNUM> big_num(big_num_ptr, BN_free);
+  return openssl_codec_util::hex_encode_batch(count, raw_bufs, raw_lens,
+                                              enc_buf, enc_offsets,
+                                              _M_codec_algo != CODEC_HEX_LOWER);
+}
 
-  if (static_cast<int>(dec_buf_len) < BN_num_bytes(big_num.get())) {
-    report_exception(
-        openssl_exception("decode: Insufficent output buffer length"));
+ssize_t openssl_codec_hex::decode_batch(size_t count,
+                                        const char *const *enc_bufs,
+                                        const size_t *enc_lens, char *dec_buf,
+                                        size_t dec_buf_len,
+                                        size_t *dec_offsets) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::hex_decode_batch(
+      count, enc_bufs, enc_lens, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, dec_offsets, status);
+
+  openssl_codec_util::report_decode_status("openssl_codec_hex::decode_batch",
+                                           status);
+  return dec_len;
+}
+
+ssize_t openssl_codec_hex::encode_update(const char *raw_buf, size_t raw_len,
+                                         char *enc_buf, size_t enc_buf_len) {
+  // Hex has no groups to carry; every chunk encodes completely.
+  const size_t enc_len = raw_len * 2;
+  if (enc_buf_len < enc_len) {
+    report_exception(openssl_exception(
+        "openssl_codec_hex::encode_update: Insufficient buffer length"));
     return -1;
   }
-  // Convert big number to hex string.
+
+  openssl_codec_util::hex_encode(
+      reinterpret_cast<const unsigned char *>(raw_buf), raw_len, enc_buf,
+      _M_codec_algo != CODEC_HEX_LOWER, _M_num_threads);
+  return enc_len;
+}
+
+ssize_t openssl_codec_hex::encode_final(char * /* enc_buf */,
+                                        size_t /* enc_buf_len */) {
+  return 0;
+}
+
+ssize_t openssl_codec_hex::decode_update(const char *enc_buf, size_t enc_len,
+                                         char *dec_buf, size_t dec_buf_len) {
+  openssl_codec_util::decode_status status;
+  const ssize_t dec_len = openssl_codec_util::hex_decode_update(
+      _M_decoder, enc_buf, enc_len, reinterpret_cast<unsigned char *>(dec_buf),
+      dec_buf_len, status);
+
+  if (dec_len < 0) {
+    _M_decoder = openssl_codec_util::hex_decoder();
+    openssl_codec_util::report_decode_status("openssl_codec_hex::decode_update",
+                                             status);
+  }
+  return dec_len;
+}
+
+ssize_t openssl_codec_hex::decode_final(char * /* dec_buf */,
+                                        size_t /* dec_buf_len */) {
+  openssl_codec_util::decode_status status;
   const ssize_t dec_len =
-      BN_bn2bin(big_num.get(), reinterpret_cast<unsigned char *>(dec_buf));
+      openssl_codec_util::hex_decode_final(_M_decoder, status);
 
+  openssl_codec_util::report_decode_status("openssl_codec_hex::decode_final",
+                                           status);
   return dec_len;
 }
 
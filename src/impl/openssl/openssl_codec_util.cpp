@@ -0,0 +1,2153 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cryptcpp/codec_alphabet.hpp>
+#include <cryptcpp/impl/openssl/openssl_codec_util.hpp>
+#include <cryptcpp/impl/openssl/openssl_exception.hpp>
+#include <cryptcpp/impl/openssl/openssl_thread_util.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CRYPTCPP_X86_SIMD
+// GCC's own intrinsics self initialize their undefined vectors, which it
+// reports once they are inlined with optimization.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+namespace cryptcpp {
+
+namespace openssl_codec_util {
+
+// =====================================================================
+// Base-64 tables.
+// =====================================================================
+
+// Special (non sextet) values in the decoding table besides 0xff for
+// invalid characters. All of them have the high bit set, which the vector
+// kernels rely upon.
+static const unsigned char B64_SPACE = 0xfe;
+static const unsigned char B64_PAD = 0xfd;
+
+static const unsigned char base64_std_decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xfe, 0xff,
+    0xff, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff,
+    0xff, 0xfd, 0xff, 0xff, 0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24,
+    0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+    0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff};
+
+static const unsigned char base64_url_decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xfe, 0xff,
+    0xff, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff,
+    0xff, 0xfd, 0xff, 0xff, 0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0x3f,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24,
+    0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+    0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff};
+
+// A Base-64 alphabet: the characters of the 64 sextet values and the
+// decoding table. Both alphabets share the first 62 characters; the vector
+// kernels rely upon it and only special-case the last two.
+struct base64_alphabet {
+  const char *chars;
+  const unsigned char *decode_table;
+  bool url_safe;
+};
+
+static const base64_alphabet base64_std = {codec_alphabet::base64_std,
+                                           base64_std_decode_table, false};
+static const base64_alphabet base64_url = {codec_alphabet::base64_url,
+                                           base64_url_decode_table, true};
+
+static const base64_alphabet &get_base64_alphabet(int format) {
+  return ((format & BASE64_URL) ? base64_url : base64_std);
+}
+
+// Characters per line and raw bytes per line in wrapped Base-64.
+static const size_t B64_LINE_CHARS = 64;
+static const size_t B64_LINE_BYTES = 48;
+
+// =====================================================================
+// Base-64 kernels.
+//
+// An encoding kernel consumes whole 3-byte groups from src as long as its
+// loads stay within avail bytes, and returns the number of bytes consumed.
+// A decoding kernel consumes whole 4-character groups until it meets a
+// character outside the alphabet or runs out of output space, and returns
+// the number of characters consumed; it loads every block before storing
+// it and never writes past what it has read, so dst may be src for
+// decoding in place. Wider kernels hand their remainder
+// down to the narrower ones, clearing the upper vector state first so the
+// legacy SSE code that follows does not pay a transition penalty.
+// =====================================================================
+
+typedef size_t (*base64_encode_kernel)(const unsigned char *src, size_t len,
+                                       size_t avail, char *dst,
+                                       const base64_alphabet &alpha);
+
+typedef size_t (*base64_decode_kernel)(const char *src, size_t len,
+                                       unsigned char *dst, size_t dst_len,
+                                       const base64_alphabet &alpha);
+
+static size_t base64_encode_scalar(const unsigned char *src, size_t len,
+                                   size_t /*avail*/, char *dst,
+                                   const base64_alphabet &alpha) {
+  const char *const chars = alpha.chars;
+  const unsigned char *const start = src;
+  for (; len >= 3; len -= 3, src += 3, dst += 4) {
+    const unsigned int v = (src[0] << 16) | (src[1] << 8) | src[2];
+    dst[0] = chars[v >> 18];
+    dst[1] = chars[(v >> 12) & 0x3f];
+    dst[2] = chars[(v >> 6) & 0x3f];
+    dst[3] = chars[v & 0x3f];
+  }
+  return (src - start);
+}
+
+static size_t base64_decode_scalar(const char *src, size_t len,
+                                   unsigned char *dst, size_t dst_len,
+                                   const base64_alphabet &alpha) {
+  const unsigned char *const table = alpha.decode_table;
+  const char *const start = src;
+  for (; len >= 4 && dst_len >= 3; len -= 4, src += 4, dst += 3, dst_len -= 3) {
+    const unsigned char a = table[static_cast<unsigned char>(src[0])];
+    const unsigned char b = table[static_cast<unsigned char>(src[1])];
+    const unsigned char c = table[static_cast<unsigned char>(src[2])];
+    const unsigned char d = table[static_cast<unsigned char>(src[3])];
+    if ((a | b | c | d) & 0xc0) {
+      break;
+    }
+    const unsigned int v = (a << 18) | (b << 12) | (c << 6) | d;
+    dst[0] = static_cast<unsigned char>(v >> 16);
+    dst[1] = static_cast<unsigned char>(v >> 8);
+    dst[2] = static_cast<unsigned char>(v);
+  }
+  return (src - start);
+}
+
+#ifdef CRYPTCPP_X86_SIMD
+
+// SSSE3: 12 bytes <-> 16 characters per step (Mula & Lemire).
+
+// The offsets added to the sextet values of each alphabet range; the
+// last two characters are taken from the alphabet.
+__attribute__((target("ssse3"))) static inline __m128i
+base64_shift_lut_ssse3(const base64_alphabet &alpha) {
+  return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                       '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                       '0' - 52, static_cast<char>(alpha.chars[62] - 62),
+                       static_cast<char>(alpha.chars[63] - 63), 'A', 0, 0);
+}
+
+__attribute__((target("ssse3"))) static inline __m128i
+base64_encode_ssse3_block(__m128i in, __m128i shift_lut) {
+  in = _mm_shuffle_epi8(
+      in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(t1, t3);
+
+  // Map each 6-bit index to the offset of its alphabet range.
+  __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  range = _mm_or_si128(range, _mm_and_si128(less, _mm_set1_epi8(13)));
+  return _mm_add_epi8(_mm_shuffle_epi8(shift_lut, range), indices);
+}
+
+__attribute__((target("ssse3"))) static size_t
+base64_encode_ssse3(const unsigned char *src, size_t len, size_t avail,
+                    char *dst, const base64_alphabet &alpha) {
+  const __m128i shift_lut = base64_shift_lut_ssse3(alpha);
+
+  size_t done = 0;
+  for (; done + 12 <= len && done + 16 <= avail; done += 12, dst += 16) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + done));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+                     base64_encode_ssse3_block(in, shift_lut));
+  }
+  return done + base64_encode_scalar(src + done, len - done, avail - done, dst,
+                                     alpha);
+}
+
+// Translates the URL-safe alphabet to the standard one: '-' and '_'
+// become '+' and '/', while '+' and '/' become NUL to fail validation.
+__attribute__((target("ssse3"))) static inline __m128i
+base64_url_to_std_ssse3(__m128i in) {
+  const __m128i is_std = _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('+')),
+                                      _mm_cmpeq_epi8(in, _mm_set1_epi8('/')));
+  const __m128i delta = _mm_or_si128(
+      _mm_and_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('-')),
+                    _mm_set1_epi8('+' - '-')),
+      _mm_and_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('_')),
+                    _mm_set1_epi8('/' - '_')));
+  return _mm_andnot_si128(is_std, _mm_add_epi8(in, delta));
+}
+
+// Returns the packed 12 bytes in the low part of the result, or sets
+// invalid to a non-zero bit mask of the characters outside the alphabet.
+__attribute__((target("ssse3"))) static inline __m128i
+base64_decode_ssse3_block(__m128i in, int &invalid) {
+  const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+  const __m128i hi_nibbles =
+      _mm_and_si128(_mm_srli_epi32(in, 4), nibble_mask);
+  const __m128i lo_nibbles = _mm_and_si128(in, nibble_mask);
+  const __m128i lut_lo =
+      _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                    0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m128i lut_hi =
+      _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+  const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+  invalid = _mm_movemask_epi8(
+      _mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128()));
+
+  const __m128i lut_roll =
+      _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i eq_2f = _mm_cmpeq_epi8(in, _mm_set1_epi8(0x2f));
+  const __m128i roll =
+      _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+  const __m128i values = _mm_add_epi8(in, roll);
+
+  // Merge sextets into 24-bit groups, then pack the groups.
+  const __m128i merged = _mm_madd_epi16(
+      _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)),
+      _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14,
+                                                13, 12, -1, -1, -1, -1));
+}
+
+__attribute__((target("ssse3"))) static size_t
+base64_decode_ssse3(const char *src, size_t len, unsigned char *dst,
+                    size_t dst_len, const base64_alphabet &alpha) {
+  size_t done = 0;
+  for (; done + 16 <= len && dst_len >= 16; done += 16, dst += 12,
+                                            dst_len -= 12) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + done));
+    if (alpha.url_safe) {
+      in = base64_url_to_std_ssse3(in);
+    }
+    int invalid;
+    const __m128i out = base64_decode_ssse3_block(in, invalid);
+    if (invalid) {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), out);
+  }
+  return done + base64_decode_scalar(src + done, len - done, dst, dst_len,
+                                     alpha);
+}
+
+// AVX2: the SSSE3 algorithm on two 128-bit lanes; 24 bytes <-> 32 characters.
+
+__attribute__((target("avx2"))) static size_t
+base64_encode_avx2(const unsigned char *src, size_t len, size_t avail,
+                   char *dst, const base64_alphabet &alpha) {
+  const __m256i shuffle = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5,
+      4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m256i shift_lut =
+      _mm256_broadcastsi128_si256(base64_shift_lut_ssse3(alpha));
+
+  size_t done = 0;
+  for (; done + 24 <= len && done + 28 <= avail; done += 24, dst += 32) {
+    __m256i in = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + done))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + done + 12)),
+        1);
+    in = _mm256_shuffle_epi8(in, shuffle);
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(t1, t3);
+
+    __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    range = _mm256_or_si256(range, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(dst),
+        _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, range), indices));
+  }
+  _mm256_zeroupper();
+  return done +
+         base64_encode_ssse3(src + done, len - done, avail - done, dst, alpha);
+}
+
+__attribute__((target("avx2"))) static size_t
+base64_decode_avx2(const char *src, size_t len, unsigned char *dst,
+                   size_t dst_len, const base64_alphabet &alpha) {
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+  const __m256i lut_lo = _mm256_setr_epi8(
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a,
+      0x1b, 0x1b, 0x1b, 0x1a, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m256i lut_hi = _mm256_setr_epi8(
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lut_roll = _mm256_setr_epi8(
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4,
+      -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i pack = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4,
+      10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+  size_t done = 0;
+  for (; done + 32 <= len && dst_len >= 32; done += 32, dst += 24,
+                                            dst_len -= 24) {
+    __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + done));
+    if (alpha.url_safe) {
+      // As base64_url_to_std_ssse3().
+      const __m256i is_std =
+          _mm256_or_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('+')),
+                          _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/')));
+      const __m256i delta = _mm256_or_si256(
+          _mm256_and_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('-')),
+                           _mm256_set1_epi8('+' - '-')),
+          _mm256_and_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('_')),
+                           _mm256_set1_epi8('/' - '_')));
+      in = _mm256_andnot_si256(is_std, _mm256_add_epi8(in, delta));
+    }
+    const __m256i hi_nibbles =
+        _mm256_and_si256(_mm256_srli_epi32(in, 4), nibble_mask);
+    const __m256i lo = _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(in, nibble_mask));
+    const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_and_si256(lo, hi),
+                                               _mm256_setzero_si256()))) {
+      break;
+    }
+
+    const __m256i eq_2f = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(0x2f));
+    const __m256i roll =
+        _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+    const __m256i merged = _mm256_madd_epi16(
+        _mm256_maddubs_epi16(_mm256_add_epi8(in, roll),
+                             _mm256_set1_epi32(0x01400140)),
+        _mm256_set1_epi32(0x00011000));
+    const __m256i out = _mm256_permutevar8x32_epi32(
+        _mm256_shuffle_epi8(merged, pack),
+        _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), out);
+  }
+  _mm256_zeroupper();
+  return done +
+         base64_decode_ssse3(src + done, len - done, dst, dst_len, alpha);
+}
+
+// AVX-512 VBMI: byte permutes do the whole lookup; 48 bytes <-> 64
+// characters per step with masked loads and stores.
+
+static const __mmask64 B64_MASK48 = 0x0000ffffffffffffULL;
+
+__attribute__((target("avx512f,avx512bw,avx512vbmi"))) static size_t
+base64_encode_avx512(const unsigned char *src, size_t len, size_t avail,
+                     char *dst, const base64_alphabet &alpha) {
+  const __m512i shuffle = _mm512_setr_epi32(
+      0x01020001, 0x04050304, 0x07080607, 0x0a0b090a, 0x0d0e0c0d, 0x10110f10,
+      0x13141213, 0x16171516, 0x191a1819, 0x1c1d1b1c, 0x1f201e1f, 0x22232122,
+      0x25262425, 0x28292728, 0x2b2c2a2b, 0x2e2f2d2e);
+  const __m512i shifts = _mm512_set1_epi64(0x3036242a1016040aLL);
+  const __m512i lookup = _mm512_loadu_si512(alpha.chars);
+
+  size_t done = 0;
+  for (; done + 48 <= len; done += 48, dst += 64) {
+    const __m512i in = _mm512_maskz_loadu_epi8(B64_MASK48, src + done);
+    const __m512i indices =
+        _mm512_multishift_epi64_epi8(shifts, _mm512_permutexvar_epi8(shuffle, in));
+    _mm512_storeu_si512(dst, _mm512_permutexvar_epi8(indices, lookup));
+  }
+  _mm256_zeroupper();
+  return done +
+         base64_encode_avx2(src + done, len - done, avail - done, dst, alpha);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vbmi"))) static size_t
+base64_decode_avx512(const char *src, size_t len, unsigned char *dst,
+                     size_t dst_len, const base64_alphabet &alpha) {
+  const __m512i lookup_lo = _mm512_loadu_si512(alpha.decode_table);
+  const __m512i lookup_hi = _mm512_loadu_si512(alpha.decode_table + 64);
+  const __m512i pack = _mm512_setr_epi32(
+      0x06000102, 0x090a0405, 0x0c0d0e08, 0x16101112, 0x191a1415, 0x1c1d1e18,
+      0x26202122, 0x292a2425, 0x2c2d2e28, 0x36303132, 0x393a3435, 0x3c3d3e38,
+      0, 0, 0, 0);
+
+  size_t done = 0;
+  for (; done + 64 <= len && dst_len >= 48; done += 64, dst += 48,
+                                            dst_len -= 48) {
+    const __m512i in = _mm512_loadu_si512(src + done);
+    const __m512i values = _mm512_permutex2var_epi8(lookup_lo, in, lookup_hi);
+    if (_mm512_movepi8_mask(_mm512_or_si512(values, in))) {
+      break;
+    }
+    const __m512i merged = _mm512_madd_epi16(
+        _mm512_maddubs_epi16(values, _mm512_set1_epi32(0x01400140)),
+        _mm512_set1_epi32(0x00011000));
+    _mm512_mask_storeu_epi8(dst, B64_MASK48,
+                            _mm512_permutexvar_epi8(pack, merged));
+  }
+  _mm256_zeroupper();
+  return done +
+         base64_decode_avx2(src + done, len - done, dst, dst_len, alpha);
+}
+
+#endif // CRYPTCPP_X86_SIMD
+
+// =====================================================================
+// Hex tables.
+// =====================================================================
+
+static const unsigned char hex_decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff};
+
+// =====================================================================
+// Hex kernels.
+//
+// An encoding kernel expands whole input bytes into two digits each and
+// returns the number of bytes consumed. A decoding kernel consumes digit
+// pairs until it meets a non-hex character and returns the number of
+// characters consumed. The caller guarantees room for the output.
+// =====================================================================
+
+typedef size_t (*hex_encode_kernel)(const unsigned char *src, size_t len,
+                                    char *dst, const char *digits);
+
+typedef size_t (*hex_decode_kernel)(const char *src, size_t len,
+                                    unsigned char *dst);
+
+static size_t hex_encode_scalar(const unsigned char *src, size_t len,
+                                char *dst, const char *digits) {
+  for (size_t i = 0; i < len; ++i, dst += 2) {
+    dst[0] = digits[src[i] >> 4];
+    dst[1] = digits[src[i] & 0x0f];
+  }
+  return len;
+}
+
+static size_t hex_decode_scalar(const char *src, size_t len,
+                                unsigned char *dst) {
+  size_t done = 0;
+  for (; done + 2 <= len; done += 2, ++dst) {
+    const unsigned char hi =
+        hex_decode_table[static_cast<unsigned char>(src[done])];
+    const unsigned char lo =
+        hex_decode_table[static_cast<unsigned char>(src[done + 1])];
+    if ((hi | lo) & 0xf0) {
+      break;
+    }
+    *dst = static_cast<unsigned char>((hi << 4) | lo);
+  }
+  return done;
+}
+
+#ifdef CRYPTCPP_X86_SIMD
+
+// SSSE3: 16 bytes <-> 32 digits per step. Nibbles index a digit table on
+// encoding; on decoding digits and letters are range checked separately.
+
+__attribute__((target("ssse3"))) static size_t
+hex_encode_ssse3(const unsigned char *src, size_t len, char *dst,
+                 const char *digits) {
+  const __m128i lut =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(digits));
+  const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+
+  size_t done = 0;
+  for (; done + 16 <= len; done += 16, dst += 32) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + done));
+    const __m128i hi =
+        _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), nibble_mask));
+    const __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, nibble_mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+                     _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16),
+                     _mm_unpackhi_epi8(hi, lo));
+  }
+  return done + hex_encode_scalar(src + done, len - done, dst, digits);
+}
+
+// Converts 16 digits to nibbles, setting invalid to a non-zero bit mask of
+// the non-hex characters.
+__attribute__((target("ssse3"))) static inline __m128i
+hex_nibbles_ssse3(__m128i in, int &invalid) {
+  const __m128i digit = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+  const __m128i alpha = _mm_sub_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)),
+                                     _mm_set1_epi8('a'));
+  const __m128i is_digit =
+      _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+  const __m128i is_alpha =
+      _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+  invalid = _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) ^ 0xffff;
+  return _mm_or_si128(
+      _mm_and_si128(is_digit, digit),
+      _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3"))) static size_t
+hex_decode_ssse3(const char *src, size_t len, unsigned char *dst) {
+  const __m128i weights = _mm_set1_epi16(0x0110);
+
+  size_t done = 0;
+  for (; done + 32 <= len; done += 32, dst += 16) {
+    int invalid_0, invalid_1;
+    const __m128i n0 = hex_nibbles_ssse3(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + done)),
+        invalid_0);
+    const __m128i n1 = hex_nibbles_ssse3(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + done + 16)),
+        invalid_1);
+    if (invalid_0 | invalid_1) {
+      break;
+    }
+    // hi * 16 + lo for every digit pair.
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+                     _mm_packus_epi16(_mm_maddubs_epi16(n0, weights),
+                                      _mm_maddubs_epi16(n1, weights)));
+  }
+  return done + hex_decode_scalar(src + done, len - done, dst);
+}
+
+// AVX2: 32 bytes <-> 64 digits per step.
+
+__attribute__((target("avx2"))) static size_t
+hex_encode_avx2(const unsigned char *src, size_t len, char *dst,
+                const char *digits) {
+  const __m256i lut = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(digits)));
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+
+  size_t done = 0;
+  for (; done + 32 <= len; done += 32, dst += 64) {
+    const __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + done));
+    const __m256i hi = _mm256_shuffle_epi8(
+        lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble_mask));
+    const __m256i lo =
+        _mm256_shuffle_epi8(lut, _mm256_and_si256(in, nibble_mask));
+    // Unpacking works per lane; restore the byte order across lanes.
+    const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst),
+                        _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 32),
+                        _mm256_permute2x128_si256(a, b, 0x31));
+  }
+  _mm256_zeroupper();
+  return done + hex_encode_ssse3(src + done, len - done, dst, digits);
+}
+
+__attribute__((target("avx2"))) static inline __m256i
+hex_nibbles_avx2(__m256i in, int &invalid) {
+  const __m256i digit = _mm256_sub_epi8(in, _mm256_set1_epi8('0'));
+  const __m256i alpha = _mm256_sub_epi8(
+      _mm256_or_si256(in, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+  const __m256i is_digit =
+      _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+  const __m256i is_alpha =
+      _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+  invalid = ~_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha));
+  return _mm256_or_si256(
+      _mm256_and_si256(is_digit, digit),
+      _mm256_and_si256(is_alpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2"))) static size_t
+hex_decode_avx2(const char *src, size_t len, unsigned char *dst) {
+  const __m256i weights = _mm256_set1_epi16(0x0110);
+
+  size_t done = 0;
+  for (; done + 64 <= len; done += 64, dst += 32) {
+    int invalid_0, invalid_1;
+    const __m256i n0 = hex_nibbles_avx2(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + done)),
+        invalid_0);
+    const __m256i n1 = hex_nibbles_avx2(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + done + 32)),
+        invalid_1);
+    if (invalid_0 | invalid_1) {
+      break;
+    }
+    // Packing works per lane; restore the qword order across lanes.
+    const __m256i packed = _mm256_packus_epi16(
+        _mm256_maddubs_epi16(n0, weights), _mm256_maddubs_epi16(n1, weights));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst),
+                        _mm256_permute4x64_epi64(packed, 0xd8));
+  }
+  _mm256_zeroupper();
+  return done + hex_decode_ssse3(src + done, len - done, dst);
+}
+
+// AVX-512: bytes are widened to words so that both nibbles of a byte land
+// next to each other; 32 bytes <-> 64 digits per step.
+
+__attribute__((target("avx512f,avx512bw"))) static size_t
+hex_encode_avx512(const unsigned char *src, size_t len, char *dst,
+                  const char *digits) {
+  const __m512i lut = _mm512_broadcast_i32x4(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(digits)));
+
+  size_t done = 0;
+  for (; done + 32 <= len; done += 32, dst += 64) {
+    const __m512i in = _mm512_cvtepu8_epi16(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + done)));
+    const __m512i nibbles = _mm512_and_si512(
+        _mm512_or_si512(_mm512_srli_epi16(in, 4), _mm512_slli_epi16(in, 8)),
+        _mm512_set1_epi16(0x0f0f));
+    _mm512_storeu_si512(dst, _mm512_shuffle_epi8(lut, nibbles));
+  }
+  _mm256_zeroupper();
+  return done + hex_encode_avx2(src + done, len - done, dst, digits);
+}
+
+__attribute__((target("avx512f,avx512bw"))) static size_t
+hex_decode_avx512(const char *src, size_t len, unsigned char *dst) {
+  size_t done = 0;
+  for (; done + 64 <= len; done += 64, dst += 32) {
+    const __m512i in = _mm512_loadu_si512(src + done);
+    const __m512i digit = _mm512_sub_epi8(in, _mm512_set1_epi8('0'));
+    const __m512i alpha = _mm512_sub_epi8(
+        _mm512_or_si512(in, _mm512_set1_epi8(0x20)), _mm512_set1_epi8('a'));
+    const __mmask64 is_digit =
+        _mm512_cmple_epu8_mask(digit, _mm512_set1_epi8(9));
+    const __mmask64 is_alpha =
+        _mm512_cmple_epu8_mask(alpha, _mm512_set1_epi8(5));
+    if (~(is_digit | is_alpha)) {
+      break;
+    }
+    const __m512i nibbles = _mm512_mask_add_epi8(
+        digit, is_alpha, alpha, _mm512_set1_epi8(10));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(dst),
+        _mm512_cvtepi16_epi8(
+            _mm512_maddubs_epi16(nibbles, _mm512_set1_epi16(0x0110))));
+  }
+  _mm256_zeroupper();
+  return done + hex_decode_avx2(src + done, len - done, dst);
+}
+
+#endif // CRYPTCPP_X86_SIMD
+
+#ifdef CRYPTCPP_X86_SIMD
+//@{
+// @brief Instruction set extensions the kernels may use, in rising order.
+//@}
+enum simd_level { SIMD_NONE, SIMD_SSSE3, SIMD_AVX2, SIMD_AVX512 };
+
+//@{
+// @brief Returns the highest extension the kernels may use. The
+// CRYPTCPP_CODEC_SIMD environment variable set to "avx2", "ssse3" or
+// "none" lowers it, so that every kernel can be tested on any CPU.
+//@}
+static simd_level get_simd_cap() {
+  const char *const cap = getenv("CRYPTCPP_CODEC_SIMD");
+  if (!cap) {
+    return SIMD_AVX512;
+  }
+  if (!strcmp(cap, "none")) {
+    return SIMD_NONE;
+  }
+  if (!strcmp(cap, "ssse3")) {
+    return SIMD_SSSE3;
+  }
+  if (!strcmp(cap, "avx2")) {
+    return SIMD_AVX2;
+  }
+  return SIMD_AVX512;
+}
+#endif
+
+//@{
+// @brief The kernels best suited for the running CPU.
+//@}
+struct codec_kernels {
+  base64_encode_kernel base64_encode;
+  base64_decode_kernel base64_decode;
+  hex_encode_kernel hex_encode;
+  hex_decode_kernel hex_decode;
+
+  codec_kernels()
+      : base64_encode(base64_encode_scalar),
+        base64_decode(base64_decode_scalar), hex_encode(hex_encode_scalar),
+        hex_decode(hex_decode_scalar) {
+#ifdef CRYPTCPP_X86_SIMD
+    __builtin_cpu_init();
+    const simd_level cap = get_simd_cap();
+    if (cap >= SIMD_AVX512 && __builtin_cpu_supports("avx512bw")) {
+      hex_encode = hex_encode_avx512;
+      hex_decode = hex_decode_avx512;
+    } else if (cap >= SIMD_AVX2 && __builtin_cpu_supports("avx2")) {
+      hex_encode = hex_encode_avx2;
+      hex_decode = hex_decode_avx2;
+    } else if (cap >= SIMD_SSSE3 && __builtin_cpu_supports("ssse3")) {
+      hex_encode = hex_encode_ssse3;
+      hex_decode = hex_decode_ssse3;
+    }
+
+    if (cap >= SIMD_AVX512 && __builtin_cpu_supports("avx512vbmi") &&
+        __builtin_cpu_supports("avx512bw")) {
+      base64_encode = base64_encode_avx512;
+      base64_decode = base64_decode_avx512;
+    } else if (cap >= SIMD_AVX2 && __builtin_cpu_supports("avx2")) {
+      base64_encode = base64_encode_avx2;
+      base64_decode = base64_decode_avx2;
+    } else if (cap >= SIMD_SSSE3 && __builtin_cpu_supports("ssse3")) {
+      base64_encode = base64_encode_ssse3;
+      base64_decode = base64_decode_ssse3;
+    }
+#endif
+  }
+};
+
+static const codec_kernels &get_codec_kernels() {
+  // Static object in function scope to maintain initialization order.
+  static const codec_kernels _S_kernels;
+  return _S_kernels;
+}
+
+codec::decode_error get_decode_error(decode_status status) {
+  switch (status) {
+  case DECODE_OK:
+    return codec::DECODE_ERROR_NONE;
+  case DECODE_BAD_CHAR:
+    return codec::DECODE_ERROR_CHAR;
+  case DECODE_BAD_PADDING:
+    return codec::DECODE_ERROR_PADDING;
+  case DECODE_BAD_LENGTH:
+    return codec::DECODE_ERROR_LENGTH;
+  case DECODE_SHORT_BUFFER:
+    return codec::DECODE_ERROR_BUFFER;
+  default:
+    return codec::DECODE_ERROR_CHAR;
+  }
+}
+
+// =====================================================================
+// Partitioning for multi-threaded one-shot calls.
+// =====================================================================
+
+// Below this many input bytes per thread, splitting costs more than the
+// thread start up saves.
+static const size_t PARALLEL_MIN_CHUNK = 256 * 1024;
+
+// Returns the length of the pieces a job over len bytes is split into for
+// num_threads threads; a multiple of align so every piece starts on a
+// group (and line) boundary.
+static size_t parallel_chunk_len(size_t len, size_t align,
+                                 size_t num_threads) {
+  size_t chunk_len = (len + num_threads - 1) / num_threads;
+  if (chunk_len < PARALLEL_MIN_CHUNK) {
+    chunk_len = PARALLEL_MIN_CHUNK;
+  }
+  return ((chunk_len + align - 1) / align * align);
+}
+
+// =====================================================================
+// Base-64 engine.
+// =====================================================================
+
+// Encodes whole groups without line breaks.
+static size_t base64_encode_groups(const codec_kernels &kernels,
+                                   const base64_alphabet &alpha,
+                                   const unsigned char *src, size_t len,
+                                   size_t avail, char *dst) {
+  // The kernels end in the scalar one, so all of the groups get consumed.
+  return (kernels.base64_encode(src, len, avail, dst, alpha) / 3 * 4);
+}
+
+// Encodes whole groups, breaking lines where the encoder's line state
+// requires.
+static size_t base64_encode_lines(const codec_kernels &kernels,
+                                  base64_encoder &state,
+                                  const unsigned char *src, size_t len,
+                                  size_t avail, char *dst, int format) {
+  const base64_alphabet &alpha = get_base64_alphabet(format);
+  if (!(format & BASE64_WRAP_LINES)) {
+    return base64_encode_groups(kernels, alpha, src, len, avail, dst);
+  }
+
+  char *out = dst;
+  while (len) {
+    const size_t room = (B64_LINE_CHARS - state.line_len) / 4 * 3;
+    const size_t take = (len < room) ? len : room;
+    const size_t chars =
+        base64_encode_groups(kernels, alpha, src, take, avail, out);
+    out += chars;
+    state.line_len += chars;
+    if (state.line_len == B64_LINE_CHARS) {
+      *out++ = '\n';
+      state.line_len = 0;
+    }
+    src += take;
+    len -= take;
+    avail -= take;
+  }
+  return (out - dst);
+}
+
+// Returns the number of characters the last, incomplete group of len
+// bytes encodes to.
+static size_t base64_tail_len(size_t len, int format) {
+  return (len ? ((format & BASE64_NO_PAD) ? len + 1 : 4) : 0);
+}
+
+size_t base64_encoded_len(size_t raw_len, int format) {
+  const size_t enc_len =
+      raw_len / 3 * 4 + base64_tail_len(raw_len % 3, format);
+  return ((format & BASE64_WRAP_LINES)
+              ? enc_len + (enc_len + B64_LINE_CHARS - 1) / B64_LINE_CHARS
+              : enc_len);
+}
+
+size_t base64_encode_update_len(const base64_encoder &state, size_t raw_len,
+                                int format) {
+  const size_t enc_len = (state.carry_len + raw_len) / 3 * 4;
+  return ((format & BASE64_WRAP_LINES)
+              ? enc_len + (state.line_len + enc_len) / B64_LINE_CHARS
+              : enc_len);
+}
+
+size_t base64_encode_update(base64_encoder &state, const unsigned char *raw,
+                            size_t raw_len, char *enc, int format) {
+  const codec_kernels &kernels = get_codec_kernels();
+  char *out = enc;
+
+  // Complete the group carried over from the previous chunk first.
+  if (state.carry_len) {
+    while (state.carry_len < 3 && raw_len) {
+      state.carry[state.carry_len++] = *raw++;
+      --raw_len;
+    }
+    if (state.carry_len < 3) {
+      return 0;
+    }
+    out += base64_encode_lines(kernels, state, state.carry, 3, 3, out,
+                               format);
+    state.carry_len = 0;
+  }
+
+  const size_t whole = raw_len - raw_len % 3;
+  out += base64_encode_lines(kernels, state, raw, whole, raw_len, out,
+                             format);
+
+  for (size_t i = whole; i < raw_len; ++i) {
+    state.carry[state.carry_len++] = raw[i];
+  }
+  return (out - enc);
+}
+
+size_t base64_encode_final_len(const base64_encoder &state, int format) {
+  const size_t tail_len = base64_tail_len(state.carry_len, format);
+  return (tail_len +
+          (((format & BASE64_WRAP_LINES) && state.line_len + tail_len) ? 1
+                                                                        : 0));
+}
+
+size_t base64_encode_final(base64_encoder &state, char *enc, int format) {
+  char *out = enc;
+
+  if (state.carry_len) {
+    const char *const chars = get_base64_alphabet(format).chars;
+    const unsigned char *src = state.carry;
+    const unsigned int v =
+        (src[0] << 16) | ((state.carry_len > 1) ? (src[1] << 8) : 0);
+    *out++ = chars[v >> 18];
+    *out++ = chars[(v >> 12) & 0x3f];
+    if (state.carry_len > 1) {
+      *out++ = chars[(v >> 6) & 0x3f];
+    }
+    if (!(format & BASE64_NO_PAD)) {
+      while (out - enc < 4) {
+        *out++ = '=';
+      }
+    }
+    state.line_len += out - enc;
+  }
+
+  // Same layout as OpenSSL's EVP_EncodeUpdate: 64 characters and a
+  // newline per line; a partial last line is newline terminated too.
+  if ((format & BASE64_WRAP_LINES) && state.line_len) {
+    *out++ = '\n';
+  }
+
+  state = base64_encoder();
+  return (out - enc);
+}
+
+// A multi-threaded Base-64 encoding job.
+struct base64_encode_job {
+  const unsigned char *raw;
+  size_t raw_len;
+  char *enc;
+  int format;
+  size_t chunk_len;
+};
+
+static void base64_encode_serial(const unsigned char *raw, size_t raw_len,
+                                 char *enc, int format) {
+  base64_encoder state;
+  const size_t enc_len =
+      base64_encode_update(state, raw, raw_len, enc, format);
+  base64_encode_final(state, enc + enc_len, format);
+}
+
+static void base64_encode_task(void *ctx, size_t task) {
+  const base64_encode_job &job = *static_cast<base64_encode_job *>(ctx);
+  const size_t start = task * job.chunk_len;
+  const size_t len = (job.raw_len - start < job.chunk_len)
+                         ? job.raw_len - start
+                         : job.chunk_len;
+
+  // Every piece but the last is a whole number of lines, so it lands at
+  // the same offset, and encodes the same, as in a serial run.
+  base64_encode_serial(job.raw + start, len,
+                       job.enc + base64_encoded_len(start, job.format),
+                       job.format);
+}
+
+size_t base64_encode(const unsigned char *raw, size_t raw_len, char *enc,
+                     int format, size_t num_threads) {
+  base64_encode_job job;
+  job.raw = raw;
+  job.raw_len = raw_len;
+  job.enc = enc;
+  job.format = format;
+  job.chunk_len = parallel_chunk_len(raw_len, B64_LINE_BYTES, num_threads);
+
+  openssl_thread_util::run_tasks(base64_encode_task, &job,
+                                 (raw_len + job.chunk_len - 1) / job.chunk_len,
+                                 num_threads);
+  return base64_encoded_len(raw_len, format);
+}
+
+// Decodes a chunk of a stream with the given kernels. In strict mode
+// whitespace other than the newlines of BASE64_WRAP_LINES and padding
+// under BASE64_NO_PAD are rejected; BASE64_WRAP_LINES input must break
+// after every full line, and may break at its end only otherwise. stop is
+// set to where decoding ended, the offending character on error.
+static ssize_t base64_decode_chunk(const codec_kernels &kernels,
+                                   const base64_alphabet &alpha,
+                                   base64_decoder &state, const char *enc,
+                                   size_t enc_len, unsigned char *dec,
+                                   size_t dec_len, int format, bool strict,
+                                   decode_status &status, const char *&stop) {
+  const char *const end = enc + enc_len;
+  const bool lines = strict && (format & BASE64_WRAP_LINES);
+  const char *line = enc;
+  unsigned char *out = dec;
+  size_t out_left = dec_len;
+
+  for (const char *p = enc; p < end; ++p) {
+    // Hand over to the kernels at every group boundary; they stop at
+    // whitespace, padding or an invalid character, and here at the end
+    // of a line whose breaks are checked.
+    if (!state.nsext && !state.npad) {
+      const char *const kend =
+          (lines && static_cast<size_t>(end - line) > B64_LINE_CHARS)
+              ? line + B64_LINE_CHARS
+              : end;
+      const size_t done =
+          kernels.base64_decode(p, kend - p, out, out_left, alpha);
+      p += done;
+      out += done / 4 * 3;
+      out_left -= done / 4 * 3;
+      if (p == end) {
+        break;
+      }
+    }
+
+    if (lines) {
+      if (*p == '\n') {
+        if (static_cast<size_t>(p - line) != B64_LINE_CHARS &&
+            (p == line || p + 1 != end)) {
+          status = DECODE_BAD_CHAR;
+          stop = p;
+          return -1;
+        }
+        line = p + 1;
+        continue;
+      }
+      if (static_cast<size_t>(p - line) == B64_LINE_CHARS) {
+        // A full line not followed by its break.
+        status = DECODE_BAD_CHAR;
+        stop = p;
+        return -1;
+      }
+    }
+
+    const unsigned char v = alpha.decode_table[static_cast<unsigned char>(*p)];
+    if (v < 64) {
+      if (state.npad) {
+        status = DECODE_BAD_PADDING;
+        stop = p;
+        return -1;
+      }
+      state.acc = (state.acc << 6) | v;
+      if (++state.nsext == 4) {
+        if (out_left < 3) {
+          status = DECODE_SHORT_BUFFER;
+          stop = p;
+          return -1;
+        }
+        out[0] = static_cast<unsigned char>(state.acc >> 16);
+        out[1] = static_cast<unsigned char>(state.acc >> 8);
+        out[2] = static_cast<unsigned char>(state.acc);
+        out += 3;
+        out_left -= 3;
+        state.acc = state.nsext = 0;
+      }
+    } else if (v == B64_PAD) {
+      if (state.nsext < 2 || state.nsext + ++state.npad > 4 ||
+          (strict && (format & BASE64_NO_PAD))) {
+        status = DECODE_BAD_PADDING;
+        stop = p;
+        return -1;
+      }
+    } else if (v != B64_SPACE ||
+               (strict && !(*p == '\n' && (format & BASE64_WRAP_LINES)))) {
+      status = DECODE_BAD_CHAR;
+      stop = p;
+      return -1;
+    }
+  }
+
+  status = DECODE_OK;
+  stop = end;
+  return (out - dec);
+}
+
+ssize_t base64_decode_update(base64_decoder &state, const char *enc,
+                             size_t enc_len, unsigned char *dec,
+                             size_t dec_len, int format,
+                             decode_status &status) {
+  const char *stop;
+  return base64_decode_chunk(get_codec_kernels(), get_base64_alphabet(format),
+                             state, enc, enc_len, dec, dec_len, format, false,
+                             status, stop);
+}
+
+ssize_t base64_decode_final(base64_decoder &state, unsigned char *dec,
+                            size_t dec_len, decode_status &status) {
+  const unsigned int nsext = state.nsext;
+  unsigned int acc = state.acc;
+  state = base64_decoder();
+
+  // A trailing partial group carries one or two bytes.
+  if (nsext == 1) {
+    status = DECODE_BAD_LENGTH;
+    return -1;
+  }
+  if (dec_len < (nsext ? nsext - 1 : 0)) {
+    status = DECODE_SHORT_BUFFER;
+    return -1;
+  }
+
+  unsigned char *out = dec;
+  if (nsext) {
+    acc <<= 6 * (4 - nsext);
+    *out++ = static_cast<unsigned char>(acc >> 16);
+    if (nsext == 3) {
+      *out++ = static_cast<unsigned char>(acc >> 8);
+    }
+  }
+
+  status = DECODE_OK;
+  return (out - dec);
+}
+
+ssize_t base64_decode(const char *enc, size_t enc_len, unsigned char *dec,
+                      size_t dec_len, int format, decode_status &status) {
+  base64_decoder state;
+  const ssize_t len =
+      base64_decode_update(state, enc, enc_len, dec, dec_len, format, status);
+  if (len < 0) {
+    return -1;
+  }
+  const ssize_t tail =
+      base64_decode_final(state, dec + len, dec_len - len, status);
+  return ((tail < 0) ? -1 : len + tail);
+}
+
+ssize_t base64_decode_strict(const char *enc, size_t enc_len,
+                             unsigned char *dec, size_t dec_len, int format,
+                             decode_status &status, size_t &error_offset) {
+  base64_decoder state;
+  const char *stop;
+  const ssize_t len = base64_decode_chunk(
+      get_codec_kernels(), get_base64_alphabet(format), state, enc, enc_len,
+      dec, dec_len, format, true, status, stop);
+  if (len < 0) {
+    error_offset = stop - enc;
+    return -1;
+  }
+
+  // The last group must be complete: padded unless BASE64_NO_PAD, and
+  // with the bits below its last byte clear.
+  error_offset = enc_len;
+  if (state.nsext == 1) {
+    status = DECODE_BAD_LENGTH;
+    return -1;
+  }
+  if (state.nsext && !(format & BASE64_NO_PAD) &&
+      state.nsext + state.npad != 4) {
+    status = DECODE_BAD_PADDING;
+    return -1;
+  }
+  if (state.acc & ((1u << (2 * (4 - state.nsext))) - 1)) {
+    // Blame the last sextet, found behind the padding and newlines.
+    do {
+      --error_offset;
+    } while (enc[error_offset] == '=' || enc[error_offset] == '\n');
+    status = DECODE_BAD_PADDING;
+    return -1;
+  }
+
+  const ssize_t tail =
+      base64_decode_final(state, dec + len, dec_len - len, status);
+  return ((tail < 0) ? -1 : len + tail);
+}
+
+size_t base64_encode_batch(size_t count, const char *const *raw,
+                           const size_t *raw_lens, char *enc,
+                           size_t *enc_offsets, int format) {
+  const codec_kernels &kernels = get_codec_kernels();
+  char *out = enc;
+
+  for (size_t i = 0; i < count; ++i) {
+    const unsigned char *src = reinterpret_cast<const unsigned char *>(raw[i]);
+    const size_t len = raw_lens[i];
+    const size_t whole = len - len % 3;
+
+    enc_offsets[i] = out - enc;
+    base64_encoder state;
+    out += base64_encode_lines(kernels, state, src, whole, len, out,
+                               format);
+    for (size_t j = whole; j < len; ++j) {
+      state.carry[state.carry_len++] = src[j];
+    }
+    out += base64_encode_final(state, out, format);
+  }
+
+  enc_offsets[count] = out - enc;
+  return (out - enc);
+}
+
+ssize_t base64_decode_batch(size_t count, const char *const *enc,
+                            const size_t *enc_lens, unsigned char *dec,
+                            size_t dec_len, size_t *dec_offsets, int format,
+                            decode_status &status) {
+  const codec_kernels &kernels = get_codec_kernels();
+  const base64_alphabet &alpha = get_base64_alphabet(format);
+  unsigned char *out = dec;
+
+  for (size_t i = 0; i < count; ++i) {
+    const size_t out_left = dec_len - (out - dec);
+    dec_offsets[i] = out - dec;
+
+    base64_decoder state;
+    const char *stop;
+    const ssize_t len =
+        base64_decode_chunk(kernels, alpha, state, enc[i], enc_lens[i], out,
+                            out_left, format, false, status, stop);
+    if (len < 0) {
+      return -1;
+    }
+    const ssize_t tail =
+        base64_decode_final(state, out + len, out_left - len, status);
+    if (tail < 0) {
+      return -1;
+    }
+    out += len + tail;
+  }
+
+  dec_offsets[count] = out - dec;
+  status = DECODE_OK;
+  return (out - dec);
+}
+
+// =====================================================================
+// Hex engine.
+// =====================================================================
+
+// A multi-threaded hex encoding job.
+struct hex_encode_job {
+  const unsigned char *raw;
+  size_t raw_len;
+  char *enc;
+  const char *digits;
+  size_t chunk_len;
+};
+
+static void hex_encode_task(void *ctx, size_t task) {
+  const hex_encode_job &job = *static_cast<hex_encode_job *>(ctx);
+  const size_t start = task * job.chunk_len;
+  const size_t len = (job.raw_len - start < job.chunk_len)
+                         ? job.raw_len - start
+                         : job.chunk_len;
+
+  get_codec_kernels().hex_encode(job.raw + start, len, job.enc + 2 * start,
+                                 job.digits);
+}
+
+size_t hex_encode(const unsigned char *raw, size_t raw_len, char *enc,
+                  bool upper_case, size_t num_threads) {
+  hex_encode_job job;
+  job.raw = raw;
+  job.raw_len = raw_len;
+  job.enc = enc;
+  job.digits =
+      upper_case ? codec_alphabet::hex_upper : codec_alphabet::hex_lower;
+  job.chunk_len = parallel_chunk_len(raw_len, 1, num_threads);
+
+  openssl_thread_util::run_tasks(hex_encode_task, &job,
+                                 (raw_len + job.chunk_len - 1) / job.chunk_len,
+                                 num_threads);
+  return (raw_len * 2);
+}
+
+// A multi-threaded hex decoding job; every piece records how far it
+// decoded.
+struct hex_decode_job {
+  const char *enc;
+  size_t enc_len;
+  unsigned char *dec;
+  size_t chunk_len;
+  std::vector<size_t> done;
+};
+
+static void hex_decode_task(void *ctx, size_t task) {
+  hex_decode_job &job = *static_cast<hex_decode_job *>(ctx);
+  const size_t start = task * job.chunk_len;
+  const size_t len = (job.enc_len - start < job.chunk_len)
+                         ? job.enc_len - start
+                         : job.chunk_len;
+
+  job.done[task] = get_codec_kernels().hex_decode(job.enc + start, len,
+                                                  job.dec + start / 2);
+}
+
+ssize_t hex_decode(const char *enc, size_t enc_len, unsigned char *dec,
+                   size_t dec_len, decode_status &status,
+                   size_t num_threads) {
+  size_t error_offset;
+  return hex_decode_strict(enc, enc_len, dec, dec_len, status, error_offset,
+                           num_threads);
+}
+
+ssize_t hex_decode_strict(const char *enc, size_t enc_len, unsigned char *dec,
+                          size_t dec_len, decode_status &status,
+                          size_t &error_offset, size_t num_threads) {
+  error_offset = enc_len;
+  if (enc_len % 2) {
+    status = DECODE_BAD_LENGTH;
+    return -1;
+  }
+  if (dec_len < enc_len / 2) {
+    error_offset = 2 * dec_len;
+    status = DECODE_SHORT_BUFFER;
+    return -1;
+  }
+
+  // Pieces decoded in place would overwrite input still to be read by the
+  // threads decoding the pieces before them.
+  const char *const dec_chars = reinterpret_cast<const char *>(dec);
+  if (dec_chars < enc + enc_len && enc < dec_chars + dec_len) {
+    num_threads = 1;
+  }
+
+  const size_t chunk_len = parallel_chunk_len(enc_len, 2, num_threads);
+  const size_t num_tasks = (enc_len + chunk_len - 1) / chunk_len;
+  size_t bad = enc_len;
+
+  if (num_threads <= 1 || num_tasks <= 1) {
+    // Nothing to fan out; decode directly without the job bookkeeping.
+    const size_t done = get_codec_kernels().hex_decode(enc, enc_len, dec);
+    if (done < enc_len) {
+      bad = done;
+    }
+  } else {
+    hex_decode_job job;
+    job.enc = enc;
+    job.enc_len = enc_len;
+    job.dec = dec;
+    job.chunk_len = chunk_len;
+    job.done.resize(num_tasks);
+    openssl_thread_util::run_tasks(hex_decode_task, &job, num_tasks,
+                                   num_threads);
+    for (size_t task = 0; task < num_tasks; ++task) {
+      const size_t start = task * chunk_len;
+      if (start + job.done[task] < enc_len && job.done[task] != chunk_len) {
+        bad = start + job.done[task];
+        break;
+      }
+    }
+  }
+
+  if (bad < enc_len) {
+    // The kernels stop at the first bad pair; either digit may be bad.
+    error_offset = bad;
+    if (hex_decode_table[static_cast<unsigned char>(enc[error_offset])] < 16) {
+      ++error_offset;
+    }
+    status = DECODE_BAD_CHAR;
+    return -1;
+  }
+
+  status = DECODE_OK;
+  return (enc_len / 2);
+}
+
+ssize_t hex_decode_update(hex_decoder &state, const char *enc, size_t enc_len,
+                          unsigned char *dec, size_t dec_len,
+                          decode_status &status) {
+  if (dec_len < (state.has_carry + enc_len) / 2) {
+    status = DECODE_SHORT_BUFFER;
+    return -1;
+  }
+
+  unsigned char *out = dec;
+
+  // Pair the digit carried over from the previous chunk first.
+  if (state.has_carry && enc_len) {
+    const char pair[2] = {state.carry, *enc};
+    if (get_codec_kernels().hex_decode(pair, 2, out) != 2) {
+      status = DECODE_BAD_CHAR;
+      return -1;
+    }
+    ++out;
+    ++enc;
+    --enc_len;
+    state.has_carry = false;
+  }
+
+  const size_t whole = enc_len - enc_len % 2;
+  if (get_codec_kernels().hex_decode(enc, whole, out) != whole) {
+    status = DECODE_BAD_CHAR;
+    return -1;
+  }
+  out += whole / 2;
+
+  if (whole < enc_len) {
+    state.carry = enc[whole];
+    state.has_carry = true;
+  }
+
+  status = DECODE_OK;
+  return (out - dec);
+}
+
+ssize_t hex_decode_final(hex_decoder &state, decode_status &status) {
+  const bool has_carry = state.has_carry;
+  state = hex_decoder();
+
+  // A dangling digit is only known to be bad once the stream ends.
+  if (has_carry) {
+    status = DECODE_BAD_LENGTH;
+    return -1;
+  }
+
+  status = DECODE_OK;
+  return 0;
+}
+
+size_t hex_encode_batch(size_t count, const char *const *raw,
+                        const size_t *raw_lens, char *enc, size_t *enc_offsets,
+                        bool upper_case) {
+  const codec_kernels &kernels = get_codec_kernels();
+  const char *const digits =
+      upper_case ? codec_alphabet::hex_upper : codec_alphabet::hex_lower;
+  char *out = enc;
+
+  for (size_t i = 0; i < count; ++i) {
+    enc_offsets[i] = out - enc;
+    kernels.hex_encode(reinterpret_cast<const unsigned char *>(raw[i]),
+                       raw_lens[i], out, digits);
+    out += raw_lens[i] * 2;
+  }
+
+  enc_offsets[count] = out - enc;
+  return (out - enc);
+}
+
+ssize_t hex_decode_batch(size_t count, const char *const *enc,
+                         const size_t *enc_lens, unsigned char *dec,
+                         size_t dec_len, size_t *dec_offsets,
+                         decode_status &status) {
+  const codec_kernels &kernels = get_codec_kernels();
+  unsigned char *out = dec;
+
+  for (size_t i = 0; i < count; ++i) {
+    const size_t len = enc_lens[i];
+    if (len % 2) {
+      status = DECODE_BAD_LENGTH;
+      return -1;
+    }
+    if (dec_len - (out - dec) < len / 2) {
+      status = DECODE_SHORT_BUFFER;
+      return -1;
+    }
+
+    dec_offsets[i] = out - dec;
+    if (kernels.hex_decode(enc[i], len, out) != len) {
+      status = DECODE_BAD_CHAR;
+      return -1;
+    }
+    out += len / 2;
+  }
+
+  dec_offsets[count] = out - dec;
+  status = DECODE_OK;
+  return (out - dec);
+}
+
+// =====================================================================
+// Base-32 tables.
+// =====================================================================
+
+// Special (non quintet) values in the decoding tables besides 0xff for
+// invalid characters, the same as for Base-64. Letters of either case
+// decode alike.
+static const unsigned char B32_SPACE = 0xfe;
+static const unsigned char B32_PAD = 0xfd;
+
+static const unsigned char base32_std_decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xfe, 0xff,
+    0xff, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xfd, 0xff, 0xff, 0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+    0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff};
+
+static const unsigned char base32_hex_decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xfe, 0xff,
+    0xff, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff,
+    0xff, 0xfd, 0xff, 0xff, 0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+    0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c,
+    0x1d, 0x1e, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14,
+    0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff};
+
+// A Base-32 alphabet: the characters of the 32 quintet values and the
+// decoding table.
+struct base32_alphabet {
+  const char *chars;
+  const unsigned char *decode_table;
+};
+
+static const base32_alphabet base32_std = {codec_alphabet::base32_std,
+                                           base32_std_decode_table};
+static const base32_alphabet base32_hex = {codec_alphabet::base32_hex,
+                                           base32_hex_decode_table};
+
+static const base32_alphabet &get_base32_alphabet(bool hex_alphabet) {
+  return (hex_alphabet ? base32_hex : base32_std);
+}
+
+// Bytes carried by a last group of n characters, negative for lengths no
+// encoding ends with.
+static const int base32_tail_bytes[8] = {0, -1, 1, -1, 2, 3, -1, 4};
+
+// Characters a last group of n bytes encodes to, before padding.
+static const size_t base32_tail_chars[5] = {0, 2, 4, 5, 7};
+
+// =====================================================================
+// Base-32 kernels.
+//
+// A 5-byte block is gathered into one 40-bit word, from which the eight
+// characters are cut without branching; decoding looks up eight
+// characters and tests the OR of their values once per block. As with
+// Base-64, the decoding kernel stops at the first character outside the
+// alphabet and never writes past what it has read.
+// =====================================================================
+
+static size_t base32_encode_blocks(const unsigned char *src, size_t len,
+                                   char *dst, const char *chars) {
+  const unsigned char *const start = src;
+  for (; len >= 5; len -= 5, src += 5, dst += 8) {
+    const uint64_t v = (static_cast<uint64_t>(src[0]) << 32) |
+                       (static_cast<uint64_t>(src[1]) << 24) |
+                       (src[2] << 16) | (src[3] << 8) | src[4];
+    dst[0] = chars[v >> 35];
+    dst[1] = chars[(v >> 30) & 0x1f];
+    dst[2] = chars[(v >> 25) & 0x1f];
+    dst[3] = chars[(v >> 20) & 0x1f];
+    dst[4] = chars[(v >> 15) & 0x1f];
+    dst[5] = chars[(v >> 10) & 0x1f];
+    dst[6] = chars[(v >> 5) & 0x1f];
+    dst[7] = chars[v & 0x1f];
+  }
+  return (src - start);
+}
+
+static size_t base32_decode_blocks(const char *src, size_t len,
+                                   unsigned char *dst, size_t dst_len,
+                                   const unsigned char *table) {
+  const char *const start = src;
+  for (; len >= 8 && dst_len >= 5;
+       len -= 8, src += 8, dst += 5, dst_len -= 5) {
+    unsigned char q[8];
+    unsigned char bad = 0;
+    for (int i = 0; i < 8; ++i) {
+      q[i] = table[static_cast<unsigned char>(src[i])];
+      bad |= q[i];
+    }
+    if (bad & 0xe0) {
+      break;
+    }
+    const uint64_t v = (static_cast<uint64_t>(q[0]) << 35) |
+                       (static_cast<uint64_t>(q[1]) << 30) |
+                       (static_cast<uint64_t>(q[2]) << 25) |
+                       (q[3] << 20) | (q[4] << 15) | (q[5] << 10) |
+                       (q[6] << 5) | q[7];
+    dst[0] = static_cast<unsigned char>(v >> 32);
+    dst[1] = static_cast<unsigned char>(v >> 24);
+    dst[2] = static_cast<unsigned char>(v >> 16);
+    dst[3] = static_cast<unsigned char>(v >> 8);
+    dst[4] = static_cast<unsigned char>(v);
+  }
+  return (src - start);
+}
+
+// =====================================================================
+// Base-32 engine.
+// =====================================================================
+
+size_t base32_encoded_len(size_t raw_len) { return ((raw_len + 4) / 5 * 8); }
+
+size_t base32_encode_update_len(const base32_encoder &state, size_t raw_len) {
+  return ((state.carry_len + raw_len) / 5 * 8);
+}
+
+size_t base32_encode_update(base32_encoder &state, const unsigned char *raw,
+                            size_t raw_len, char *enc, bool hex_alphabet) {
+  const char *const chars = get_base32_alphabet(hex_alphabet).chars;
+  char *out = enc;
+
+  // Complete the block carried over from the previous chunk first.
+  if (state.carry_len) {
+    while (state.carry_len < 5 && raw_len) {
+      state.carry[state.carry_len++] = *raw++;
+      --raw_len;
+    }
+    if (state.carry_len < 5) {
+      return 0;
+    }
+    out += base32_encode_blocks(state.carry, 5, out, chars) / 5 * 8;
+    state.carry_len = 0;
+  }
+
+  const size_t whole = raw_len - raw_len % 5;
+  out += base32_encode_blocks(raw, whole, out, chars) / 5 * 8;
+
+  for (size_t i = whole; i < raw_len; ++i) {
+    state.carry[state.carry_len++] = raw[i];
+  }
+  return (out - enc);
+}
+
+size_t base32_encode_final_len(const base32_encoder &state) {
+  return (state.carry_len ? 8 : 0);
+}
+
+size_t base32_encode_final(base32_encoder &state, char *enc,
+                           bool hex_alphabet) {
+  const size_t carry_len = state.carry_len;
+  if (!carry_len) {
+    return 0;
+  }
+
+  // Encode the block zero filled, then pad over the characters that only
+  // carry the fill.
+  unsigned char block[5] = {0, 0, 0, 0, 0};
+  for (size_t i = 0; i < carry_len; ++i) {
+    block[i] = state.carry[i];
+  }
+  state = base32_encoder();
+
+  base32_encode_blocks(block, 5, enc, get_base32_alphabet(hex_alphabet).chars);
+  for (size_t i = base32_tail_chars[carry_len]; i < 8; ++i) {
+    enc[i] = '=';
+  }
+  return 8;
+}
+
+// A multi-threaded Base-32 encoding job.
+struct base32_encode_job {
+  const unsigned char *raw;
+  size_t raw_len;
+  char *enc;
+  bool hex_alphabet;
+  size_t chunk_len;
+};
+
+static void base32_encode_task(void *ctx, size_t task) {
+  const base32_encode_job &job = *static_cast<base32_encode_job *>(ctx);
+  const size_t start = task * job.chunk_len;
+  const size_t len = (job.raw_len - start < job.chunk_len)
+                         ? job.raw_len - start
+                         : job.chunk_len;
+
+  // Every piece but the last is a whole number of blocks.
+  base32_encoder state;
+  char *const enc = job.enc + start / 5 * 8;
+  const size_t enc_len =
+      base32_encode_update(state, job.raw + start, len, enc, job.hex_alphabet);
+  base32_encode_final(state, enc + enc_len, job.hex_alphabet);
+}
+
+size_t base32_encode(const unsigned char *raw, size_t raw_len, char *enc,
+                     bool hex_alphabet, size_t num_threads) {
+  base32_encode_job job;
+  job.raw = raw;
+  job.raw_len = raw_len;
+  job.enc = enc;
+  job.hex_alphabet = hex_alphabet;
+  job.chunk_len = parallel_chunk_len(raw_len, 5, num_threads);
+
+  openssl_thread_util::run_tasks(base32_encode_task, &job,
+                                 (raw_len + job.chunk_len - 1) / job.chunk_len,
+                                 num_threads);
+  return base32_encoded_len(raw_len);
+}
+
+// Decodes a chunk of a stream. In strict mode whitespace is rejected. stop
+// is set to where decoding ended, the offending character on error.
+static ssize_t base32_decode_chunk(const base32_alphabet &alpha,
+                                   base32_decoder &state, const char *enc,
+                                   size_t enc_len, unsigned char *dec,
+                                   size_t dec_len, bool strict,
+                                   decode_status &status, const char *&stop) {
+  const char *const end = enc + enc_len;
+  unsigned char *out = dec;
+  size_t out_left = dec_len;
+
+  for (const char *p = enc; p < end; ++p) {
+    // Decode whole blocks at every block boundary; the kernel stops at
+    // whitespace, padding or an invalid character.
+    if (!state.nchars && !state.npad) {
+      const size_t done = base32_decode_blocks(p, end - p, out, out_left,
+                                               alpha.decode_table);
+      p += done;
+      out += done / 8 * 5;
+      out_left -= done / 8 * 5;
+      if (p == end) {
+        break;
+      }
+    }
+
+    const unsigned char v = alpha.decode_table[static_cast<unsigned char>(*p)];
+    if (v < 32) {
+      if (state.npad) {
+        status = DECODE_BAD_PADDING;
+        stop = p;
+        return -1;
+      }
+      state.acc = (state.acc << 5) | v;
+      if (++state.nchars == 8) {
+        if (out_left < 5) {
+          status = DECODE_SHORT_BUFFER;
+          stop = p;
+          return -1;
+        }
+        for (int i = 0; i < 5; ++i) {
+          out[i] = static_cast<unsigned char>(state.acc >> (32 - 8 * i));
+        }
+        out += 5;
+        out_left -= 5;
+        state.acc = 0;
+        state.nchars = 0;
+      }
+    } else if (v == B32_PAD) {
+      if (base32_tail_bytes[state.nchars] <= 0 ||
+          state.nchars + ++state.npad > 8) {
+        status = DECODE_BAD_PADDING;
+        stop = p;
+        return -1;
+      }
+    } else if (v != B32_SPACE || strict) {
+      status = DECODE_BAD_CHAR;
+      stop = p;
+      return -1;
+    }
+  }
+
+  status = DECODE_OK;
+  stop = end;
+  return (out - dec);
+}
+
+ssize_t base32_decode_update(base32_decoder &state, const char *enc,
+                             size_t enc_len, unsigned char *dec,
+                             size_t dec_len, bool hex_alphabet,
+                             decode_status &status) {
+  const char *stop;
+  return base32_decode_chunk(get_base32_alphabet(hex_alphabet), state, enc,
+                             enc_len, dec, dec_len, false, status, stop);
+}
+
+ssize_t base32_decode_final(base32_decoder &state, unsigned char *dec,
+                            size_t dec_len, decode_status &status) {
+  const int tail = base32_tail_bytes[state.nchars];
+  const uint64_t acc = state.acc << (5 * (8 - state.nchars));
+  state = base32_decoder();
+
+  if (tail < 0) {
+    status = DECODE_BAD_LENGTH;
+    return -1;
+  }
+  if (dec_len < static_cast<size_t>(tail)) {
+    status = DECODE_SHORT_BUFFER;
+    return -1;
+  }
+
+  for (int i = 0; i < tail; ++i) {
+    dec[i] = static_cast<unsigned char>(acc >> (32 - 8 * i));
+  }
+
+  status = DECODE_OK;
+  return tail;
+}
+
+ssize_t base32_decode(const char *enc, size_t enc_len, unsigned char *dec,
+                      size_t dec_len, bool hex_alphabet,
+                      decode_status &status) {
+  base32_decoder state;
+  const ssize_t len = base32_decode_update(state, enc, enc_len, dec, dec_len,
+                                           hex_alphabet, status);
+  if (len < 0) {
+    return -1;
+  }
+  const ssize_t tail =
+      base32_decode_final(state, dec + len, dec_len - len, status);
+  return ((tail < 0) ? -1 : len + tail);
+}
+
+ssize_t base32_decode_strict(const char *enc, size_t enc_len,
+                             unsigned char *dec, size_t dec_len,
+                             bool hex_alphabet, decode_status &status,
+                             size_t &error_offset) {
+  base32_decoder state;
+  const char *stop;
+  const ssize_t len =
+      base32_decode_chunk(get_base32_alphabet(hex_alphabet), state, enc,
+                          enc_len, dec, dec_len, true, status, stop);
+  if (len < 0) {
+    error_offset = stop - enc;
+    return -1;
+  }
+
+  // The last group must be padded to a whole block, with the bits below
+  // its last byte clear.
+  error_offset = enc_len;
+  if (base32_tail_bytes[state.nchars] < 0) {
+    status = DECODE_BAD_LENGTH;
+    return -1;
+  }
+  if (state.nchars && state.nchars + state.npad != 8) {
+    status = DECODE_BAD_PADDING;
+    return -1;
+  }
+  if (state.acc & ((1u << (5 * state.nchars % 8)) - 1)) {
+    // Blame the last quintet, found behind the padding.
+    do {
+      --error_offset;
+    } while (enc[error_offset] == '=');
+    status = DECODE_BAD_PADDING;
+    return -1;
+  }
+
+  const ssize_t tail =
+      base32_decode_final(state, dec + len, dec_len - len, status);
+  return ((tail < 0) ? -1 : len + tail);
+}
+
+size_t base32_encode_batch(size_t count, const char *const *raw,
+                           const size_t *raw_lens, char *enc,
+                           size_t *enc_offsets, bool hex_alphabet) {
+  char *out = enc;
+
+  for (size_t i = 0; i < count; ++i) {
+    enc_offsets[i] = out - enc;
+    base32_encoder state;
+    out += base32_encode_update(
+        state, reinterpret_cast<const unsigned char *>(raw[i]), raw_lens[i],
+        out, hex_alphabet);
+    out += base32_encode_final(state, out, hex_alphabet);
+  }
+
+  enc_offsets[count] = out - enc;
+  return (out - enc);
+}
+
+ssize_t base32_decode_batch(size_t count, const char *const *enc,
+                            const size_t *enc_lens, unsigned char *dec,
+                            size_t dec_len, size_t *dec_offsets,
+                            bool hex_alphabet, decode_status &status) {
+  unsigned char *out = dec;
+
+  for (size_t i = 0; i < count; ++i) {
+    dec_offsets[i] = out - dec;
+    const ssize_t len = base32_decode(enc[i], enc_lens[i], out,
+                                      dec_len - (out - dec), hex_alphabet,
+                                      status);
+    if (len < 0) {
+      return -1;
+    }
+    out += len;
+  }
+
+  dec_offsets[count] = out - dec;
+  status = DECODE_OK;
+  return (out - dec);
+}
+
+// =====================================================================
+// Base-58.
+//
+// Base-58 is positional over the whole input, so the engine works on the
+// number the input represents: 32-bit limbs are divided by 58^5 to cut
+// five digits per pass when encoding, and multiplied by up to 58^5 per
+// five digits when decoding. The limbs live on the stack for inputs of
+// typical identifier size and in a single heap block otherwise. Leading
+// zero bytes map to leading '1's.
+// =====================================================================
+
+static const unsigned char base58_decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10, 0xff, 0x11, 0x12, 0x13, 0x14, 0x15, 0xff, 0x16, 0x17, 0x18, 0x19,
+    0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b,
+    0xff, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36,
+    0x37, 0x38, 0x39, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff};
+
+// Five Base-58 digits fit in 30 bits.
+static const uint32_t B58_POW5 = 58 * 58 * 58 * 58 * 58;
+
+// Limbs kept on the stack.
+static const size_t B58_STACK_LIMBS = 64;
+
+size_t base58_max_encoded_len(size_t raw_len) {
+  // log(256) / log(58) is a little below 1.37.
+  return (raw_len * 138 / 100 + 1);
+}
+
+ssize_t base58_encode(const unsigned char *raw, size_t raw_len, char *enc,
+                      size_t enc_len) {
+  size_t zeros = 0;
+  while (zeros < raw_len && !raw[zeros]) {
+    ++zeros;
+  }
+
+  // Load the rest of the input as big endian limbs.
+  const size_t num_bytes = raw_len - zeros;
+  const size_t num_limbs = (num_bytes + 3) / 4;
+  uint32_t stack_limbs[B58_STACK_LIMBS];
+  std::vector<uint32_t> heap_limbs;
+  uint32_t *limbs = stack_limbs;
+  if (num_limbs > B58_STACK_LIMBS) {
+    heap_limbs.resize(num_limbs);
+    limbs = &heap_limbs[0];
+  }
+  const unsigned char *src = raw + zeros;
+  for (size_t i = 0; i < num_limbs; ++i) {
+    const size_t n = i ? 4 : num_bytes - (num_limbs - 1) * 4;
+    uint32_t limb = 0;
+    for (size_t j = 0; j < n; ++j) {
+      limb = (limb << 8) | *src++;
+    }
+    limbs[i] = limb;
+  }
+
+  // Cut the digits off, least significant first.
+  char *out = enc;
+  char *const end = enc + enc_len;
+  size_t first = 0;
+  while (first < num_limbs) {
+    uint64_t rem = 0;
+    for (size_t i = first; i < num_limbs; ++i) {
+      const uint64_t cur = (rem << 32) | limbs[i];
+      limbs[i] = static_cast<uint32_t>(cur / B58_POW5);
+      rem = cur % B58_POW5;
+    }
+    while (first < num_limbs && !limbs[first]) {
+      ++first;
+    }
+
+    // The most significant pass leaves out its leading zero digits.
+    for (int k = 0; k < 5 && (first < num_limbs || rem); ++k) {
+      if (out == end) {
+        return -1;
+      }
+      *out++ = codec_alphabet::base58[rem % 58];
+      rem /= 58;
+    }
+  }
+
+  if (static_cast<size_t>(end - out) < zeros) {
+    return -1;
+  }
+  for (size_t i = 0; i < zeros; ++i) {
+    *out++ = '1';
+  }
+
+  std::reverse(enc, out);
+  return (out - enc);
+}
+
+ssize_t base58_decode(const char *enc, size_t enc_len, unsigned char *dec,
+                      size_t dec_len, decode_status &status,
+                      size_t &error_offset) {
+  size_t zeros = 0;
+  while (zeros < enc_len && enc[zeros] == '1') {
+    ++zeros;
+  }
+
+  // Accumulate the number as little endian limbs, five digits at a time.
+  const size_t max_limbs = (enc_len - zeros) / 5 + 2;
+  uint32_t stack_limbs[B58_STACK_LIMBS];
+  std::vector<uint32_t> heap_limbs;
+  uint32_t *limbs = stack_limbs;
+  if (max_limbs > B58_STACK_LIMBS) {
+    heap_limbs.resize(max_limbs);
+    limbs = &heap_limbs[0];
+  }
+  size_t num_limbs = 0;
+  for (size_t pos = zeros; pos < enc_len; pos += 5) {
+    const size_t n = (enc_len - pos < 5) ? enc_len - pos : 5;
+    uint64_t carry = 0;
+    uint64_t mul = 1;
+    for (size_t j = 0; j < n; ++j) {
+      const unsigned char v =
+          base58_decode_table[static_cast<unsigned char>(enc[pos + j])];
+      if (v >= 58) {
+        status = DECODE_BAD_CHAR;
+        error_offset = pos + j;
+        return -1;
+      }
+      carry = carry * 58 + v;
+      mul *= 58;
+    }
+    for (size_t i = 0; i < num_limbs; ++i) {
+      const uint64_t cur = limbs[i] * mul + carry;
+      limbs[i] = static_cast<uint32_t>(cur);
+      carry = cur >> 32;
+    }
+    if (carry) {
+      limbs[num_limbs++] = static_cast<uint32_t>(carry);
+    }
+  }
+
+  size_t num_bytes = num_limbs * 4;
+  if (num_limbs) {
+    for (uint32_t top = limbs[num_limbs - 1]; !(top >> 24); top <<= 8) {
+      --num_bytes;
+    }
+  }
+  if (dec_len < zeros + num_bytes) {
+    status = DECODE_SHORT_BUFFER;
+    error_offset = enc_len;
+    return -1;
+  }
+
+  // All of the input has been read, so dec may be enc.
+  unsigned char *out = dec;
+  for (size_t i = 0; i < zeros; ++i) {
+    *out++ = 0;
+  }
+  for (size_t i = num_bytes; i--;) {
+    *out++ = static_cast<unsigned char>(limbs[i / 4] >> (8 * (i % 4)));
+  }
+
+  status = DECODE_OK;
+  return (out - dec);
+}
+
+ssize_t base58_encode_batch(size_t count, const char *const *raw,
+                            const size_t *raw_lens, char *enc,
+                            size_t enc_len, size_t *enc_offsets) {
+  char *out = enc;
+
+  for (size_t i = 0; i < count; ++i) {
+    enc_offsets[i] = out - enc;
+    const ssize_t len =
+        base58_encode(reinterpret_cast<const unsigned char *>(raw[i]),
+                      raw_lens[i], out, enc_len - (out - enc));
+    if (len < 0) {
+      return -1;
+    }
+    out += len;
+  }
+
+  enc_offsets[count] = out - enc;
+  return (out - enc);
+}
+
+ssize_t base58_decode_batch(size_t count, const char *const *enc,
+                            const size_t *enc_lens, unsigned char *dec,
+                            size_t dec_len, size_t *dec_offsets,
+                            decode_status &status) {
+  unsigned char *out = dec;
+
+  for (size_t i = 0; i < count; ++i) {
+    dec_offsets[i] = out - dec;
+    size_t error_offset;
+    const ssize_t len = base58_decode(enc[i], enc_lens[i], out,
+                                      dec_len - (out - dec), status,
+                                      error_offset);
+    if (len < 0) {
+      return -1;
+    }
+    out += len;
+  }
+
+  dec_offsets[count] = out - dec;
+  status = DECODE_OK;
+  return (out - dec);
+}
+
+// =====================================================================
+// Error reporting.
+// =====================================================================
+
+void report_decode_status(const char *func, decode_status status) {
+  const char *reason = nullptr;
+  switch (status) {
+  case DECODE_OK:
+    return;
+  case DECODE_BAD_CHAR:
+    reason = "Invalid character";
+    break;
+  case DECODE_BAD_PADDING:
+    reason = "Invalid padding";
+    break;
+  case DECODE_BAD_LENGTH:
+    reason = "Invalid length";
+    break;
+  case DECODE_SHORT_BUFFER:
+  default:
+    reason = "Insufficient buffer length";
+    break;
+  }
+  report_exception(openssl_exception(std::string(func) + ": " + reason));
+}
+
+} // namespace openssl_codec_util
+
+} // namespace cryptcpp
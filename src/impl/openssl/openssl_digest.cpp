@@ -8,60 +8,579 @@
 
 #include <cryptcpp/cryptcpp_util.hpp>
 #include <cryptcpp/impl/openssl/openssl_digest.hpp>
+#include <cryptcpp/impl/openssl/openssl_digest_util.hpp>
 #include <cryptcpp/impl/openssl/openssl_exception.hpp>
 
+#include <openssl/err.h>
 #include <openssl/evp.h>
-
-//#include <cstring>
-//#include <string>
+#include <openssl/objects.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/provider.h>
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
 
 namespace cryptcpp {
 
-openssl_digest::openssl_digest() : _M_md(nullptr) {}
+// Prefix of the names of the tree hash modes.
+static const char TREE_PREFIX[] = "TREE-";
+
+// Returns whether md may be calculated outside of EVP, by the library's
+// own SHA code. Only the default provider's may; others, such as the FIPS
+// one, keep their own implementations.
+static bool is_default_md(const EVP_MD *md) {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  const OSSL_PROVIDER *const prov = EVP_MD_get0_provider(md);
+  if (prov && 0 != strcmp(OSSL_PROVIDER_get0_name(prov), "default")) {
+    return false;
+  }
+#endif
+  return (md != nullptr);
+}
+
+// Creates the low level state md is calculated on if it may be, that is
+// for SHA-1 and SHA-2 of the default provider.
+static openssl_digest_util::sha_state *new_sha_state(const EVP_MD *md) {
+  if (!is_default_md(md)) {
+    return nullptr;
+  }
+  return openssl_digest_util::sha_new(EVP_MD_type(md));
+}
+
+openssl_digest::openssl_digest()
+    : _M_md(nullptr), _M_fetched_md(nullptr), _M_mdctx(nullptr),
+      _M_tree(nullptr), _M_sha(nullptr) {}
+
+openssl_digest::~openssl_digest() {
+  delete _M_tree;
+  openssl_digest_util::sha_free(_M_sha);
+  if (_M_mdctx)
+    EVP_MD_CTX_free(_M_mdctx);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  if (_M_fetched_md)
+    EVP_MD_free(_M_fetched_md);
+#endif
+}
 
 size_t openssl_digest::calculate_digest(const unsigned char *data,
                                         size_t data_len,
                                         unsigned char *digest_buf,
                                         size_t digest_buf_len) {
-  if (!_M_md) {
-    report_exception(openssl_exception("openssl_digest: Digest algo not set"));
+  if (!init() || !update(data, data_len)) {
+    return 0;
+  }
+  return final(digest_buf, digest_buf_len);
+}
+
+size_t openssl_digest::calculate_digest(const data_segment *segments,
+                                        size_t num_segments,
+                                        unsigned char *digest_buf,
+                                        size_t digest_buf_len) {
+  if (!init()) {
     return 0;
   }
+  for (size_t i = 0; i < num_segments; ++i) {
+    if (!update(segments[i].data, segments[i].data_len)) {
+      return 0;
+    }
+  }
+  return final(digest_buf, digest_buf_len);
+}
+
+// Files are mapped a window at a time, and read a block at a time when
+// they cannot be mapped.
+static const size_t FILE_MAP_WINDOW_LEN = 64 * 1024 * 1024;
+static const size_t FILE_READ_BLOCK_LEN = 1024 * 1024;
+
+//@{
+// @brief Releases the resources of a file digest calculation on every
+// return path, exceptions included.
+//@}
+struct file_digest_resources {
+  file_digest_resources()
+      : fd(-1), map(MAP_FAILED), map_len(0), buf(nullptr) {}
+
+  ~file_digest_resources() {
+    unmap();
+    free(buf);
+    if (fd >= 0)
+      close(fd);
+  }
+
+  void unmap() {
+    if (map != MAP_FAILED)
+      munmap(map, map_len);
+    map = MAP_FAILED;
+  }
 
-  cryptcpp_unique_ptr<EVP_MD_CTX> mdctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
-  if (!mdctx) {
-    report_exception(openssl_exception("EVP_MD_CTX_new:"));
+  int fd;
+  void *map;
+  size_t map_len;
+  void *buf;
+};
+
+static openssl_exception file_exception(const char *what, const char *path) {
+  return openssl_exception(
+      std::string("openssl_digest::calculate_file_digest: ") + what + " " +
+      path + ": " + strerror(errno));
+}
+
+size_t openssl_digest::calculate_file_digest(const char *path,
+                                             unsigned char *digest_buf,
+                                             size_t digest_buf_len) {
+  if (digest_buf_len < (is_xof() ? 1 : get_digest_len())) {
+    report_exception(openssl_exception(
+        "openssl_digest::calculate_file_digest: Insufficient buffer length"));
     return 0;
   }
 
-  if (1 != EVP_DigestInit(mdctx.get(), _M_md)) {
-    report_exception(openssl_exception("EVP_DigestInit:"));
+  file_digest_resources res;
+  res.fd = open(path, O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (res.fd < 0 || fstat(res.fd, &st) != 0) {
+    report_exception(file_exception("Cannot open", path));
     return 0;
   }
 
-  if (1 != EVP_DigestUpdate(mdctx.get(), data, data_len)) {
-    report_exception(openssl_exception("EVP_DigestUpdate:"));
+  if (!init()) {
     return 0;
   }
 
-  unsigned int digest_len = digest_buf_len;
-  if (1 != EVP_DigestFinal(mdctx.get(), digest_buf, &digest_len)) {
-    report_exception(openssl_exception("EVP_DigestFinal:"));
+  // Hash regular files in place through windows of the page cache.
+  off_t done = 0;
+  if (S_ISREG(st.st_mode)) {
+    while (done < st.st_size) {
+      const off_t left = st.st_size - done;
+      res.map_len = (left < static_cast<off_t>(FILE_MAP_WINDOW_LEN))
+                        ? static_cast<size_t>(left)
+                        : FILE_MAP_WINDOW_LEN;
+      res.map =
+          mmap(nullptr, res.map_len, PROT_READ, MAP_PRIVATE, res.fd, done);
+      if (res.map == MAP_FAILED) {
+        break;
+      }
+      madvise(res.map, res.map_len, MADV_SEQUENTIAL);
+      madvise(res.map, res.map_len, MADV_WILLNEED);
+
+      if (!update(static_cast<const unsigned char *>(res.map), res.map_len)) {
+        return 0;
+      }
+      res.unmap();
+      done += res.map_len;
+    }
+  }
+
+  // Read what is left: all of pipes and the like, the rest of files that
+  // could not be mapped and anything beyond the size a file reported.
+  if (done && lseek(res.fd, done, SEEK_SET) != done) {
+    report_exception(file_exception("Cannot seek", path));
+    return 0;
+  }
+#ifdef POSIX_FADV_SEQUENTIAL
+  posix_fadvise(res.fd, done, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  if (posix_memalign(&res.buf, sysconf(_SC_PAGESIZE), FILE_READ_BLOCK_LEN)) {
+    report_exception(openssl_exception(
+        "openssl_digest::calculate_file_digest: Out of memory"));
     return 0;
   }
 
-  return digest_len;
+  for (;;) {
+    const ssize_t len = read(res.fd, res.buf, FILE_READ_BLOCK_LEN);
+    if (len == 0) {
+      break;
+    }
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      report_exception(file_exception("Cannot read", path));
+      return 0;
+    }
+    if (!update(static_cast<const unsigned char *>(res.buf), len)) {
+      return 0;
+    }
+  }
+
+  return final(digest_buf, digest_buf_len);
+}
+
+size_t openssl_digest::calculate_digest_batch(size_t count,
+                                              const unsigned char *const *data,
+                                              const size_t *data_lens,
+                                              unsigned char *digest_buf,
+                                              size_t digest_buf_len) {
+  const size_t digest_len = get_digest_len();
+  if (!_M_md) {
+    report_exception(openssl_exception("openssl_digest: Digest algo not set"));
+    return 0;
+  }
+
+  if (digest_buf_len / digest_len < count) {
+    report_exception(openssl_exception(
+        "openssl_digest::calculate_digest_batch: Insufficient buffer length"));
+    return 0;
+  }
+
+  // A multi-buffer engine pays off once it has a message for at least
+  // half of its lanes. It stands in for the default provider only.
+  const int type = EVP_MD_type(_M_md);
+  if (!_M_tree && (type == NID_sha1 || type == NID_sha256) &&
+      is_default_md(_M_md)) {
+    const openssl_digest_util::mb_algorithm algo =
+        (type == NID_sha1) ? openssl_digest_util::MB_SHA1
+                           : openssl_digest_util::MB_SHA256;
+    const size_t lanes = openssl_digest_util::mb_lanes(algo);
+    if (lanes && count >= lanes / 2) {
+      openssl_digest_util::mb_digest_batch(algo, count, data, data_lens,
+                                           digest_buf);
+      return (count * digest_len);
+    }
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    if (!calculate_digest(data[i], data_lens[i], digest_buf + i * digest_len,
+                          digest_len)) {
+      return 0;
+    }
+  }
+  return (count * digest_len);
 }
 
 bool openssl_digest::set_digest_algorithm(digest_algorithm digest_algo) {
-  // Get the EVP_MD object associated with the digest algorithm.
-  const EVP_MD *eMd = EVP_get_digestbyname(digest_algo);
+  // A tree hash mode hashes with the algorithm it is named after.
+  const bool tree =
+      (0 == strncmp(digest_algo, TREE_PREFIX, sizeof(TREE_PREFIX) - 1));
+  if (tree) {
+    digest_algo += sizeof(TREE_PREFIX) - 1;
+  }
+
+  // Get the EVP_MD object associated with the digest algorithm. From
+  // OpenSSL 3 on, fetch it once here rather than implicitly on every
+  // init; legacy names the providers do not know are looked up as before.
+  EVP_MD *fetched_md = nullptr;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  ERR_set_mark();
+  fetched_md = EVP_MD_fetch(nullptr, digest_algo, nullptr);
+  ERR_pop_to_mark();
+#endif
+  const EVP_MD *eMd =
+      fetched_md ? fetched_md : EVP_get_digestbyname(digest_algo);
   if (!eMd) {
     report_exception(openssl_exception("Unsupported Digest Algorithm:"));
     return false;
   }
 
+  // Drop the state of the previous algorithm with its context.
+  if (_M_mdctx) {
+    EVP_MD_CTX_reset(_M_mdctx);
+  }
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  if (_M_fetched_md)
+    EVP_MD_free(_M_fetched_md);
+#endif
+
   _M_md = eMd;
+  _M_fetched_md = fetched_md;
+
+  delete _M_tree;
+  _M_tree = tree ? new openssl_digest_util::tree_state() : nullptr;
+  openssl_digest_util::sha_free(_M_sha);
+  _M_sha = nullptr;
+  return true;
+}
+
+bool openssl_digest::is_xof() const {
+#ifdef EVP_MD_FLAG_XOF
+  return (_M_md && !_M_tree && (EVP_MD_flags(_M_md) & EVP_MD_FLAG_XOF));
+#else
+  return false;
+#endif
+}
+
+size_t openssl_digest::get_digest_len() const {
+  return (_M_md ? EVP_MD_size(_M_md) : 0);
+}
+
+bool openssl_digest::init() {
+  if (!_M_md) {
+    report_exception(openssl_exception("openssl_digest: Digest algo not set"));
+    return false;
+  }
+
+  if (!_M_mdctx) {
+    _M_mdctx = EVP_MD_CTX_new();
+    if (!_M_mdctx) {
+      report_exception(openssl_exception("EVP_MD_CTX_new:"));
+      return false;
+    }
+  }
+
+  if (_M_tree) {
+    *_M_tree = openssl_digest_util::tree_state();
+    return true;
+  }
+
+  // Only an exportable calculation needs the low level state; EVP keeps
+  // its own optimized code and provider otherwise.
+  if (!_M_exportable) {
+    openssl_digest_util::sha_free(_M_sha);
+    _M_sha = nullptr;
+  } else if (!_M_sha) {
+    _M_sha = new_sha_state(_M_md);
+  }
+
+  if (_M_sha) {
+    if (!openssl_digest_util::sha_init(*_M_sha)) {
+      report_exception(openssl_exception("openssl_digest: SHA init failed"));
+      return false;
+    }
+    return true;
+  }
+
+  // Re-initializing keeps the context's buffers for the same algorithm.
+  if (1 != EVP_DigestInit_ex(_M_mdctx, _M_md, nullptr)) {
+    report_exception(openssl_exception("EVP_DigestInit_ex:"));
+    return false;
+  }
+
+  return true;
+}
+
+bool openssl_digest::update(const unsigned char *data, size_t data_len) {
+  if (_M_tree && _M_mdctx) {
+    if (!openssl_digest_util::tree_update(*_M_tree, _M_md, _M_mdctx, data,
+                                          data_len, _M_num_threads)) {
+      report_exception(openssl_exception("openssl_digest: Tree hash failed"));
+      return false;
+    }
+    return true;
+  }
+
+  if (_M_sha && _M_mdctx) {
+    if (!openssl_digest_util::sha_update(*_M_sha, data, data_len)) {
+      report_exception(openssl_exception("openssl_digest: SHA update failed"));
+      return false;
+    }
+    return true;
+  }
+
+  if (!_M_mdctx || 1 != EVP_DigestUpdate(_M_mdctx, data, data_len)) {
+    report_exception(openssl_exception("EVP_DigestUpdate:"));
+    return false;
+  }
+
+  return true;
+}
+
+size_t openssl_digest::final(unsigned char *digest_buf,
+                             size_t digest_buf_len) {
+  if (!_M_mdctx) {
+    report_exception(openssl_exception("openssl_digest: Digest not started"));
+    return 0;
+  }
+
+  const bool xof = is_xof();
+  if (digest_buf_len < (xof ? 1 : get_digest_len())) {
+    report_exception(
+        openssl_exception("openssl_digest::final: Insufficient buffer length"));
+    return 0;
+  }
+
+  if (_M_tree) {
+    if (!openssl_digest_util::tree_final(*_M_tree, _M_md, _M_mdctx,
+                                         digest_buf)) {
+      report_exception(openssl_exception("openssl_digest: Tree hash failed"));
+      return 0;
+    }
+    return get_digest_len();
+  }
+
+  if (_M_sha) {
+    if (!openssl_digest_util::sha_final(*_M_sha, digest_buf)) {
+      report_exception(openssl_exception("openssl_digest: SHA final failed"));
+      return 0;
+    }
+    return get_digest_len();
+  }
+
+#ifdef EVP_MD_FLAG_XOF
+  // The whole buffer is squeezed out of an extendable output function.
+  if (xof) {
+    if (1 != EVP_DigestFinalXOF(_M_mdctx, digest_buf, digest_buf_len)) {
+      report_exception(openssl_exception("EVP_DigestFinalXOF:"));
+      return 0;
+    }
+    return digest_buf_len;
+  }
+#endif
+
+  unsigned int digest_len = digest_buf_len;
+  if (1 != EVP_DigestFinal_ex(_M_mdctx, digest_buf, &digest_len)) {
+    report_exception(openssl_exception("EVP_DigestFinal_ex:"));
+    return 0;
+  }
+
+  return digest_len;
+}
+
+bool openssl_digest::copy_state(const digest &src) {
+  const openssl_digest *const other =
+      dynamic_cast<const openssl_digest *>(&src);
+  if (!other || !other->_M_mdctx) {
+    report_exception(
+        openssl_exception("openssl_digest::copy_state: Digest not started"));
+    return false;
+  }
+  if (other == this) {
+    return true;
+  }
+
+  if (!_M_mdctx) {
+    _M_mdctx = EVP_MD_CTX_new();
+    if (!_M_mdctx) {
+      report_exception(openssl_exception("EVP_MD_CTX_new:"));
+      return false;
+    }
+  }
+
+  // A tree hash and a low level calculation keep their state outside the
+  // context.
+  if (other->_M_tree) {
+    if (!_M_tree) {
+      _M_tree = new openssl_digest_util::tree_state();
+    }
+    *_M_tree = *other->_M_tree;
+  } else {
+    if (!other->_M_sha &&
+        1 != EVP_MD_CTX_copy_ex(_M_mdctx, other->_M_mdctx)) {
+      report_exception(openssl_exception("EVP_MD_CTX_copy_ex:"));
+      return false;
+    }
+    delete _M_tree;
+    _M_tree = nullptr;
+  }
+
+  if (other->_M_sha) {
+    if (!_M_sha || other->_M_md != _M_md) {
+      openssl_digest_util::sha_free(_M_sha);
+      _M_sha = openssl_digest_util::sha_new(EVP_MD_type(other->_M_md));
+    }
+    openssl_digest_util::sha_copy(*_M_sha, *other->_M_sha);
+  } else {
+    openssl_digest_util::sha_free(_M_sha);
+    _M_sha = nullptr;
+  }
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  if (other->_M_fetched_md != _M_fetched_md) {
+    if (other->_M_fetched_md)
+      EVP_MD_up_ref(other->_M_fetched_md);
+    if (_M_fetched_md)
+      EVP_MD_free(_M_fetched_md);
+  }
+#endif
+  _M_md = other->_M_md;
+  _M_fetched_md = other->_M_fetched_md;
+  return true;
+}
+
+digest *openssl_digest::clone_state() const {
+  openssl_digest *const clone = new openssl_digest();
+  clone->set_num_threads(_M_num_threads);
+  clone->set_exportable(_M_exportable);
+  if (_M_mdctx) {
+    try {
+      if (!clone->copy_state(*this)) {
+        delete clone;
+        return nullptr;
+      }
+    } catch (...) {
+      delete clone;
+      throw;
+    }
+  } else {
+    // Nothing started yet; only the algorithm, if any, is carried over.
+    clone->_M_md = _M_md;
+    clone->_M_fetched_md = _M_fetched_md;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    if (_M_fetched_md)
+      EVP_MD_up_ref(_M_fetched_md);
+#endif
+    if (_M_tree)
+      clone->_M_tree = new openssl_digest_util::tree_state();
+  }
+  return clone;
+}
+
+size_t openssl_digest::export_state(unsigned char *state_buf,
+                                    size_t state_buf_len) const {
+  if (!_M_mdctx) {
+    report_exception(
+        openssl_exception("openssl_digest::export_state: Digest not started"));
+    return 0;
+  }
+  if (!_M_sha) {
+    report_exception(openssl_exception(
+        "openssl_digest::export_state: Calculation not exportable"));
+    return 0;
+  }
+
+  const size_t state_len =
+      openssl_digest_util::sha_export(*_M_sha, state_buf, state_buf_len);
+  if (!state_len) {
+    report_exception(openssl_exception(
+        "openssl_digest::export_state: Insufficient buffer length"));
+    return 0;
+  }
+  return state_len;
+}
+
+bool openssl_digest::import_state(const unsigned char *state_buf,
+                                  size_t state_buf_len) {
+  const int nid = openssl_digest_util::sha_state_nid(state_buf, state_buf_len);
+  if (nid == NID_undef) {
+    report_exception(
+        openssl_exception("openssl_digest::import_state: Malformed state"));
+    return false;
+  }
+
+  // Switch to the algorithm of the state unless already on it.
+  if (!_M_md || _M_tree || EVP_MD_type(_M_md) != nid) {
+    if (!set_digest_algorithm(OBJ_nid2sn(nid))) {
+      return false;
+    }
+  }
+
+  if (!_M_mdctx) {
+    _M_mdctx = EVP_MD_CTX_new();
+    if (!_M_mdctx) {
+      report_exception(openssl_exception("EVP_MD_CTX_new:"));
+      return false;
+    }
+  }
+
+  // A resumed calculation continues on the low level state whether or not
+  // new ones are exportable.
+  if (!_M_sha) {
+    _M_sha = new_sha_state(_M_md);
+    if (!_M_sha) {
+      report_exception(openssl_exception(
+          "openssl_digest::import_state: Algorithm not importable"));
+      return false;
+    }
+  }
+  if (!openssl_digest_util::sha_import(*_M_sha, state_buf, state_buf_len)) {
+    report_exception(
+        openssl_exception("openssl_digest::import_state: Malformed state"));
+    return false;
+  }
   return true;
 }
 
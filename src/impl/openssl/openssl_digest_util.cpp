@@ -0,0 +1,1016 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+// The low level SHA contexts are deprecated, but are the only ones whose
+// state can be exported.
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include <cryptcpp/impl/openssl/openssl_digest_util.hpp>
+#include <cryptcpp/impl/openssl/openssl_thread_util.hpp>
+#include <algorithm>
+#include <openssl/evp.h>
+#include <openssl/objects.h>
+#include <openssl/sha.h>
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CRYPTCPP_X86_SIMD
+// See openssl_codec_util.cpp.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+namespace cryptcpp {
+
+namespace openssl_digest_util {
+
+// Both SHA-1 and SHA-256 work on 64-byte blocks of big endian 32-bit
+// words and pad alike.
+static const size_t MB_BLOCK_LEN = 64;
+static const size_t MB_BLOCK_WORDS = 16;
+
+// The kernels keep the state transposed: word i of lane l is at
+// [i * MB_MAX_LANES + l], so a row loads into one register. The message
+// words are gathered straight from the blocks of the lanes.
+static const size_t MB_MAX_LANES = 16;
+
+static const uint32_t sha1_iv[5] = {0x67452301, 0xefcdab89, 0x98badcfe,
+                                    0x10325476, 0xc3d2e1f0};
+
+static const uint32_t sha256_iv[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                      0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                      0x1f83d9ab, 0x5be0cd19};
+
+#ifdef CRYPTCPP_X86_SIMD
+
+static const uint32_t sha1_k[4] = {0x5a827999, 0x6ed9eba1, 0x8f1bbcdc,
+                                   0xca62c1d6};
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+// =====================================================================
+// AVX2: 8 lanes.
+// =====================================================================
+
+template <int _N>
+__attribute__((target("avx2"))) static inline __m256i rotr_avx2(__m256i x) {
+  return _mm256_or_si256(_mm256_srli_epi32(x, _N),
+                         _mm256_slli_epi32(x, 32 - _N));
+}
+
+__attribute__((target("avx2"))) static inline __m256i
+load_row_avx2(const uint32_t *row) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row));
+}
+
+__attribute__((target("avx2"))) static inline void
+add_row_avx2(uint32_t *row, __m256i x) {
+  __m256i *const p = reinterpret_cast<__m256i *>(row);
+  _mm256_storeu_si256(p, _mm256_add_epi32(_mm256_loadu_si256(p), x));
+}
+
+// The offsets of the blocks of the lanes from the block of lane 0, which
+// the gathers use as their base.
+static inline void block_offsets(const unsigned char *const *blocks,
+                                 size_t lanes, int64_t *offsets) {
+  const uintptr_t base = reinterpret_cast<uintptr_t>(blocks[0]);
+  for (size_t l = 0; l < lanes; ++l) {
+    offsets[l] =
+        static_cast<int64_t>(reinterpret_cast<uintptr_t>(blocks[l]) - base);
+  }
+}
+
+// Gathers big endian word t of the blocks of the 8 lanes.
+__attribute__((target("avx2"))) static inline __m256i
+gather_word_avx2(const unsigned char *base, __m256i offsets_lo,
+                 __m256i offsets_hi, size_t t) {
+  const int *const word = reinterpret_cast<const int *>(base + 4 * t);
+  const __m256i w = _mm256_setr_m128i(
+      _mm256_i64gather_epi32(word, offsets_lo, 1),
+      _mm256_i64gather_epi32(word, offsets_hi, 1));
+  return _mm256_shuffle_epi8(
+      w, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13,
+                          12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14,
+                          13, 12));
+}
+
+__attribute__((target("avx2"))) static void
+sha256_block_avx2(uint32_t *state, const unsigned char *const *blocks) {
+  int64_t offsets[8];
+  block_offsets(blocks, 8, offsets);
+  const __m256i offsets_lo =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets));
+  const __m256i offsets_hi =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets + 4));
+
+  __m256i w[MB_BLOCK_WORDS];
+  __m256i a = load_row_avx2(state + 0 * MB_MAX_LANES);
+  __m256i b = load_row_avx2(state + 1 * MB_MAX_LANES);
+  __m256i c = load_row_avx2(state + 2 * MB_MAX_LANES);
+  __m256i d = load_row_avx2(state + 3 * MB_MAX_LANES);
+  __m256i e = load_row_avx2(state + 4 * MB_MAX_LANES);
+  __m256i f = load_row_avx2(state + 5 * MB_MAX_LANES);
+  __m256i g = load_row_avx2(state + 6 * MB_MAX_LANES);
+  __m256i h = load_row_avx2(state + 7 * MB_MAX_LANES);
+
+  for (size_t t = 0; t < 64; ++t) {
+    __m256i wt;
+    if (t < MB_BLOCK_WORDS) {
+      wt = w[t] = gather_word_avx2(blocks[0], offsets_lo, offsets_hi, t);
+    } else {
+      const __m256i w15 = w[(t - 15) & 15];
+      const __m256i w2 = w[(t - 2) & 15];
+      const __m256i s0 = _mm256_xor_si256(
+          _mm256_xor_si256(rotr_avx2<7>(w15), rotr_avx2<18>(w15)),
+          _mm256_srli_epi32(w15, 3));
+      const __m256i s1 = _mm256_xor_si256(
+          _mm256_xor_si256(rotr_avx2<17>(w2), rotr_avx2<19>(w2)),
+          _mm256_srli_epi32(w2, 10));
+      wt = w[t & 15] =
+          _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0),
+                           _mm256_add_epi32(w[(t - 7) & 15], s1));
+    }
+
+    const __m256i sum1 = _mm256_xor_si256(
+        _mm256_xor_si256(rotr_avx2<6>(e), rotr_avx2<11>(e)),
+        rotr_avx2<25>(e));
+    const __m256i ch =
+        _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+    const __m256i t1 = _mm256_add_epi32(
+        _mm256_add_epi32(_mm256_add_epi32(h, sum1), ch),
+        _mm256_add_epi32(wt, _mm256_set1_epi32(sha256_k[t])));
+    const __m256i sum0 = _mm256_xor_si256(
+        _mm256_xor_si256(rotr_avx2<2>(a), rotr_avx2<13>(a)),
+        rotr_avx2<22>(a));
+    const __m256i maj = _mm256_or_si256(
+        _mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+
+    h = g;
+    g = f;
+    f = e;
+    e = _mm256_add_epi32(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = _mm256_add_epi32(t1, _mm256_add_epi32(sum0, maj));
+  }
+
+  add_row_avx2(state + 0 * MB_MAX_LANES, a);
+  add_row_avx2(state + 1 * MB_MAX_LANES, b);
+  add_row_avx2(state + 2 * MB_MAX_LANES, c);
+  add_row_avx2(state + 3 * MB_MAX_LANES, d);
+  add_row_avx2(state + 4 * MB_MAX_LANES, e);
+  add_row_avx2(state + 5 * MB_MAX_LANES, f);
+  add_row_avx2(state + 6 * MB_MAX_LANES, g);
+  add_row_avx2(state + 7 * MB_MAX_LANES, h);
+}
+
+__attribute__((target("avx2"))) static void
+sha1_block_avx2(uint32_t *state, const unsigned char *const *blocks) {
+  int64_t offsets[8];
+  block_offsets(blocks, 8, offsets);
+  const __m256i offsets_lo =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets));
+  const __m256i offsets_hi =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets + 4));
+
+  __m256i w[MB_BLOCK_WORDS];
+  __m256i a = load_row_avx2(state + 0 * MB_MAX_LANES);
+  __m256i b = load_row_avx2(state + 1 * MB_MAX_LANES);
+  __m256i c = load_row_avx2(state + 2 * MB_MAX_LANES);
+  __m256i d = load_row_avx2(state + 3 * MB_MAX_LANES);
+  __m256i e = load_row_avx2(state + 4 * MB_MAX_LANES);
+
+  for (size_t t = 0; t < 80; ++t) {
+    __m256i wt;
+    if (t < MB_BLOCK_WORDS) {
+      wt = w[t] = gather_word_avx2(blocks[0], offsets_lo, offsets_hi, t);
+    } else {
+      wt = w[t & 15] = rotr_avx2<31>(_mm256_xor_si256(
+          _mm256_xor_si256(w[(t - 3) & 15], w[(t - 8) & 15]),
+          _mm256_xor_si256(w[(t - 14) & 15], w[t & 15])));
+    }
+
+    __m256i f;
+    if (t < 20) {
+      f = _mm256_xor_si256(_mm256_and_si256(b, c), _mm256_andnot_si256(b, d));
+    } else if (t >= 40 && t < 60) {
+      f = _mm256_or_si256(_mm256_and_si256(b, c),
+                          _mm256_and_si256(d, _mm256_or_si256(b, c)));
+    } else {
+      f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+    }
+
+    const __m256i tmp = _mm256_add_epi32(
+        _mm256_add_epi32(rotr_avx2<27>(a), f),
+        _mm256_add_epi32(_mm256_add_epi32(e, wt),
+                         _mm256_set1_epi32(sha1_k[t / 20])));
+    e = d;
+    d = c;
+    c = rotr_avx2<2>(b);
+    b = a;
+    a = tmp;
+  }
+
+  add_row_avx2(state + 0 * MB_MAX_LANES, a);
+  add_row_avx2(state + 1 * MB_MAX_LANES, b);
+  add_row_avx2(state + 2 * MB_MAX_LANES, c);
+  add_row_avx2(state + 3 * MB_MAX_LANES, d);
+  add_row_avx2(state + 4 * MB_MAX_LANES, e);
+}
+
+// =====================================================================
+// AVX-512: 16 lanes, with native rotates and three input logic.
+// =====================================================================
+
+template <int _N>
+__attribute__((target("avx512f"))) static inline __m512i
+rotr_avx512(__m512i x) {
+  return _mm512_ror_epi32(x, _N);
+}
+
+// Three input logic functions; bit i of the immediate is the result for
+// the input bits x, y and z that read as the binary number i.
+__attribute__((target("avx512f"))) static inline __m512i
+choose_avx512(__m512i x, __m512i y, __m512i z) {
+  return _mm512_ternarylogic_epi32(x, y, z, 0xca);
+}
+
+__attribute__((target("avx512f"))) static inline __m512i
+majority_avx512(__m512i x, __m512i y, __m512i z) {
+  return _mm512_ternarylogic_epi32(x, y, z, 0xe8);
+}
+
+__attribute__((target("avx512f"))) static inline __m512i
+parity_avx512(__m512i x, __m512i y, __m512i z) {
+  return _mm512_ternarylogic_epi32(x, y, z, 0x96);
+}
+
+__attribute__((target("avx512f"))) static inline __m512i
+load_row_avx512(const uint32_t *row) {
+  return _mm512_loadu_si512(row);
+}
+
+__attribute__((target("avx512f"))) static inline void
+add_row_avx512(uint32_t *row, __m512i x) {
+  _mm512_storeu_si512(row, _mm512_add_epi32(_mm512_loadu_si512(row), x));
+}
+
+// Gathers big endian word t of the blocks of the 16 lanes.
+__attribute__((target("avx512f"))) static inline __m512i
+gather_word_avx512(const unsigned char *base, __m512i offsets_lo,
+                   __m512i offsets_hi, size_t t) {
+  const int *const word = reinterpret_cast<const int *>(base + 4 * t);
+  const __m512i w = _mm512_inserti64x4(
+      _mm512_castsi256_si512(_mm512_i64gather_epi32(offsets_lo, word, 1)),
+      _mm512_i64gather_epi32(offsets_hi, word, 1), 1);
+  return choose_avx512(_mm512_set1_epi32(0xff00ff00), rotr_avx512<8>(w),
+                       rotr_avx512<24>(w));
+}
+
+__attribute__((target("avx512f"))) static void
+sha256_block_avx512(uint32_t *state, const unsigned char *const *blocks) {
+  int64_t offsets[16];
+  block_offsets(blocks, 16, offsets);
+  const __m512i offsets_lo = _mm512_loadu_si512(offsets);
+  const __m512i offsets_hi = _mm512_loadu_si512(offsets + 8);
+
+  __m512i w[MB_BLOCK_WORDS];
+  __m512i a = load_row_avx512(state + 0 * MB_MAX_LANES);
+  __m512i b = load_row_avx512(state + 1 * MB_MAX_LANES);
+  __m512i c = load_row_avx512(state + 2 * MB_MAX_LANES);
+  __m512i d = load_row_avx512(state + 3 * MB_MAX_LANES);
+  __m512i e = load_row_avx512(state + 4 * MB_MAX_LANES);
+  __m512i f = load_row_avx512(state + 5 * MB_MAX_LANES);
+  __m512i g = load_row_avx512(state + 6 * MB_MAX_LANES);
+  __m512i h = load_row_avx512(state + 7 * MB_MAX_LANES);
+
+  for (size_t t = 0; t < 64; ++t) {
+    __m512i wt;
+    if (t < MB_BLOCK_WORDS) {
+      wt = w[t] = gather_word_avx512(blocks[0], offsets_lo, offsets_hi, t);
+    } else {
+      const __m512i w15 = w[(t - 15) & 15];
+      const __m512i w2 = w[(t - 2) & 15];
+      const __m512i s0 = parity_avx512(rotr_avx512<7>(w15),
+                                       rotr_avx512<18>(w15),
+                                       _mm512_srli_epi32(w15, 3));
+      const __m512i s1 = parity_avx512(rotr_avx512<17>(w2),
+                                       rotr_avx512<19>(w2),
+                                       _mm512_srli_epi32(w2, 10));
+      wt = w[t & 15] =
+          _mm512_add_epi32(_mm512_add_epi32(w[t & 15], s0),
+                           _mm512_add_epi32(w[(t - 7) & 15], s1));
+    }
+
+    const __m512i sum1 =
+        parity_avx512(rotr_avx512<6>(e), rotr_avx512<11>(e),
+                      rotr_avx512<25>(e));
+    const __m512i t1 = _mm512_add_epi32(
+        _mm512_add_epi32(_mm512_add_epi32(h, sum1), choose_avx512(e, f, g)),
+        _mm512_add_epi32(wt, _mm512_set1_epi32(sha256_k[t])));
+    const __m512i sum0 =
+        parity_avx512(rotr_avx512<2>(a), rotr_avx512<13>(a),
+                      rotr_avx512<22>(a));
+    const __m512i maj = majority_avx512(a, b, c);
+
+    h = g;
+    g = f;
+    f = e;
+    e = _mm512_add_epi32(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = _mm512_add_epi32(t1, _mm512_add_epi32(sum0, maj));
+  }
+
+  add_row_avx512(state + 0 * MB_MAX_LANES, a);
+  add_row_avx512(state + 1 * MB_MAX_LANES, b);
+  add_row_avx512(state + 2 * MB_MAX_LANES, c);
+  add_row_avx512(state + 3 * MB_MAX_LANES, d);
+  add_row_avx512(state + 4 * MB_MAX_LANES, e);
+  add_row_avx512(state + 5 * MB_MAX_LANES, f);
+  add_row_avx512(state + 6 * MB_MAX_LANES, g);
+  add_row_avx512(state + 7 * MB_MAX_LANES, h);
+}
+
+__attribute__((target("avx512f"))) static void
+sha1_block_avx512(uint32_t *state, const unsigned char *const *blocks) {
+  int64_t offsets[16];
+  block_offsets(blocks, 16, offsets);
+  const __m512i offsets_lo = _mm512_loadu_si512(offsets);
+  const __m512i offsets_hi = _mm512_loadu_si512(offsets + 8);
+
+  __m512i w[MB_BLOCK_WORDS];
+  __m512i a = load_row_avx512(state + 0 * MB_MAX_LANES);
+  __m512i b = load_row_avx512(state + 1 * MB_MAX_LANES);
+  __m512i c = load_row_avx512(state + 2 * MB_MAX_LANES);
+  __m512i d = load_row_avx512(state + 3 * MB_MAX_LANES);
+  __m512i e = load_row_avx512(state + 4 * MB_MAX_LANES);
+
+  for (size_t t = 0; t < 80; ++t) {
+    __m512i wt;
+    if (t < MB_BLOCK_WORDS) {
+      wt = w[t] = gather_word_avx512(blocks[0], offsets_lo, offsets_hi, t);
+    } else {
+      wt = w[t & 15] = rotr_avx512<31>(
+          _mm512_xor_si512(parity_avx512(w[(t - 3) & 15], w[(t - 8) & 15],
+                                         w[(t - 14) & 15]),
+                           w[t & 15]));
+    }
+
+    __m512i f;
+    if (t < 20) {
+      f = choose_avx512(b, c, d);
+    } else if (t >= 40 && t < 60) {
+      f = majority_avx512(b, c, d);
+    } else {
+      f = parity_avx512(b, c, d);
+    }
+
+    const __m512i tmp = _mm512_add_epi32(
+        _mm512_add_epi32(rotr_avx512<27>(a), f),
+        _mm512_add_epi32(_mm512_add_epi32(e, wt),
+                         _mm512_set1_epi32(sha1_k[t / 20])));
+    e = d;
+    d = c;
+    c = rotr_avx512<2>(b);
+    b = a;
+    a = tmp;
+  }
+
+  add_row_avx512(state + 0 * MB_MAX_LANES, a);
+  add_row_avx512(state + 1 * MB_MAX_LANES, b);
+  add_row_avx512(state + 2 * MB_MAX_LANES, c);
+  add_row_avx512(state + 3 * MB_MAX_LANES, d);
+  add_row_avx512(state + 4 * MB_MAX_LANES, e);
+}
+
+#endif // CRYPTCPP_X86_SIMD
+
+// =====================================================================
+// Kernel selection.
+// =====================================================================
+
+//@{
+// @brief Compresses one block of every lane into the transposed state.
+//@}
+typedef void (*mb_block_kernel)(uint32_t *state,
+                                const unsigned char *const *blocks);
+
+//@{
+// @brief A multi-buffer engine: its kernel and number of lanes.
+//@}
+struct mb_engine {
+  mb_engine() : block(nullptr), lanes(0) {}
+
+  mb_block_kernel block;
+  size_t lanes;
+};
+
+//@{
+// @brief The engines best suited for the running CPU.
+//@}
+struct digest_kernels {
+  mb_engine sha1;
+  mb_engine sha256;
+
+  digest_kernels() {
+#ifdef CRYPTCPP_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      sha1.block = sha1_block_avx512;
+      sha256.block = sha256_block_avx512;
+      sha1.lanes = sha256.lanes = 16;
+    } else if (__builtin_cpu_supports("avx2")) {
+      sha1.block = sha1_block_avx2;
+      sha256.block = sha256_block_avx2;
+      sha1.lanes = sha256.lanes = 8;
+    }
+#endif
+  }
+};
+
+static const digest_kernels &get_digest_kernels() {
+  // Static object in function scope to maintain initialization order.
+  static const digest_kernels _S_kernels;
+  return _S_kernels;
+}
+
+static const mb_engine &get_mb_engine(mb_algorithm algo) {
+  return ((algo == MB_SHA1) ? get_digest_kernels().sha1
+                            : get_digest_kernels().sha256);
+}
+
+size_t mb_lanes(mb_algorithm algo) { return get_mb_engine(algo).lanes; }
+
+// =====================================================================
+// Lane scheduling.
+// =====================================================================
+
+static inline void store_be32(unsigned char *p, uint32_t v) {
+  p[0] = static_cast<unsigned char>(v >> 24);
+  p[1] = static_cast<unsigned char>(v >> 16);
+  p[2] = static_cast<unsigned char>(v >> 8);
+  p[3] = static_cast<unsigned char>(v);
+}
+
+//@{
+// @brief A message being hashed in a lane: its whole blocks are read in
+// place, the padded last one or two blocks from a copy.
+//@}
+struct mb_lane {
+  const unsigned char *next;               // Next whole block.
+  size_t whole_blocks;                     // Whole blocks left at next.
+  unsigned char tail[2 * MB_BLOCK_LEN];    // The padded last blocks.
+  size_t tail_off;                         // Offset of next tail block.
+  size_t tail_len;                         // Length of the padded blocks.
+  size_t msg;                              // Index of the message.
+
+  void start(size_t index, const unsigned char *data, size_t data_len) {
+    const size_t rem = data_len % MB_BLOCK_LEN;
+    next = data;
+    whole_blocks = data_len / MB_BLOCK_LEN;
+    msg = index;
+
+    // The message is followed by a 1 bit, zeros and its bit length.
+    tail_off = 0;
+    tail_len = (rem + 9 <= MB_BLOCK_LEN) ? MB_BLOCK_LEN : 2 * MB_BLOCK_LEN;
+    if (rem) {
+      memcpy(tail, data + data_len - rem, rem);
+    }
+    tail[rem] = 0x80;
+    memset(tail + rem + 1, 0, tail_len - rem - 1);
+    const uint64_t bits = static_cast<uint64_t>(data_len) << 3;
+    store_be32(tail + tail_len - 8, static_cast<uint32_t>(bits >> 32));
+    store_be32(tail + tail_len - 4, static_cast<uint32_t>(bits));
+  }
+
+  const unsigned char *next_block() {
+    if (whole_blocks) {
+      const unsigned char *const block = next;
+      next += MB_BLOCK_LEN;
+      --whole_blocks;
+      return block;
+    }
+    tail_off += MB_BLOCK_LEN;
+    return (tail + tail_off - MB_BLOCK_LEN);
+  }
+
+  bool done() const { return (!whole_blocks && tail_off == tail_len); }
+};
+
+void mb_digest_batch(mb_algorithm algo, size_t count,
+                     const unsigned char *const *data, const size_t *data_lens,
+                     unsigned char *digests) {
+  const mb_engine &engine = get_mb_engine(algo);
+  const uint32_t *const iv = (algo == MB_SHA1) ? sha1_iv : sha256_iv;
+  const size_t state_words = (algo == MB_SHA1) ? 5 : 8;
+  const size_t digest_len = 4 * state_words;
+
+  // Idle lanes hash a block of zeros; their state is never read.
+  static const unsigned char idle_block[MB_BLOCK_LEN] = {0};
+
+  uint32_t state[8 * MB_MAX_LANES];
+  const unsigned char *blocks[MB_MAX_LANES];
+  mb_lane lanes[MB_MAX_LANES];
+  bool busy[MB_MAX_LANES];
+
+  size_t next_msg = 0;
+  size_t active = 0;
+  for (size_t l = 0; l < engine.lanes; ++l) {
+    busy[l] = (next_msg < count);
+    if (busy[l]) {
+      lanes[l].start(next_msg, data[next_msg], data_lens[next_msg]);
+      ++next_msg;
+      ++active;
+      for (size_t i = 0; i < state_words; ++i) {
+        state[i * MB_MAX_LANES + l] = iv[i];
+      }
+    }
+  }
+
+  while (active) {
+    for (size_t l = 0; l < engine.lanes; ++l) {
+      blocks[l] = busy[l] ? lanes[l].next_block() : idle_block;
+    }
+
+    engine.block(state, blocks);
+
+    for (size_t l = 0; l < engine.lanes; ++l) {
+      if (!busy[l] || !lanes[l].done()) {
+        continue;
+      }
+
+      unsigned char *const out = digests + lanes[l].msg * digest_len;
+      for (size_t i = 0; i < state_words; ++i) {
+        store_be32(out + 4 * i, state[i * MB_MAX_LANES + l]);
+        state[i * MB_MAX_LANES + l] = iv[i];
+      }
+
+      if (next_msg < count) {
+        lanes[l].start(next_msg, data[next_msg], data_lens[next_msg]);
+        ++next_msg;
+      } else {
+        busy[l] = false;
+        --active;
+      }
+    }
+  }
+}
+
+// =====================================================================
+// Tree hash.
+// =====================================================================
+
+// Domain separation of leaves and inner nodes, as in RFC 6962.
+static const unsigned char TREE_LEAF_PREFIX = 0x00;
+static const unsigned char TREE_NODE_PREFIX = 0x01;
+
+static bool tree_hash(const EVP_MD *md, EVP_MD_CTX *ctx, unsigned char prefix,
+                      const unsigned char *data, size_t data_len,
+                      const unsigned char *data2, size_t data2_len,
+                      unsigned char *digest) {
+  return (1 == EVP_DigestInit_ex(ctx, md, nullptr) &&
+          1 == EVP_DigestUpdate(ctx, &prefix, 1) &&
+          1 == EVP_DigestUpdate(ctx, data, data_len) &&
+          (!data2_len || 1 == EVP_DigestUpdate(ctx, data2, data2_len)) &&
+          1 == EVP_DigestFinal_ex(ctx, digest, nullptr));
+}
+
+// Pushes the root of a one leaf subtree, merging equal sized subtrees.
+static bool tree_push_leaf(tree_state &state, const EVP_MD *md,
+                           EVP_MD_CTX *ctx, const unsigned char *leaf) {
+  const size_t md_len = EVP_MD_size(md);
+  state.roots.insert(state.roots.end(), leaf, leaf + md_len);
+  state.root_leaves.push_back(1);
+
+  size_t n = state.root_leaves.size();
+  while (n > 1 && state.root_leaves[n - 2] == state.root_leaves[n - 1]) {
+    unsigned char *const left = &state.roots[(n - 2) * md_len];
+    if (!tree_hash(md, ctx, TREE_NODE_PREFIX, left, md_len, left + md_len,
+                   md_len, left)) {
+      return false;
+    }
+    state.roots.resize((n - 1) * md_len);
+    state.root_leaves.pop_back();
+    state.root_leaves[n - 2] *= 2;
+    --n;
+  }
+  return true;
+}
+
+// A multi-threaded leaf hashing job; every task hashes a run of chunks
+// with its own context.
+struct tree_leaf_job {
+  const EVP_MD *md;
+  const unsigned char *data;
+  size_t num_chunks;
+  size_t num_tasks;
+  unsigned char *leaves;
+  std::vector<char> ok;
+};
+
+static void tree_leaf_task(void *ctx, size_t task) {
+  tree_leaf_job &job = *static_cast<tree_leaf_job *>(ctx);
+  const size_t md_len = EVP_MD_size(job.md);
+  const size_t first = job.num_chunks * task / job.num_tasks;
+  const size_t last = job.num_chunks * (task + 1) / job.num_tasks;
+
+  EVP_MD_CTX *const mdctx = EVP_MD_CTX_new();
+  bool ok = (mdctx != nullptr);
+  for (size_t i = first; ok && i < last; ++i) {
+    ok = tree_hash(job.md, mdctx, TREE_LEAF_PREFIX,
+                   job.data + i * TREE_CHUNK_LEN, TREE_CHUNK_LEN, nullptr, 0,
+                   job.leaves + i * md_len);
+  }
+  EVP_MD_CTX_free(mdctx);
+  job.ok[task] = ok;
+}
+
+bool tree_update(tree_state &state, const EVP_MD *md, EVP_MD_CTX *ctx,
+                 const unsigned char *data, size_t data_len,
+                 size_t num_threads) {
+  const size_t md_len = EVP_MD_size(md);
+  unsigned char leaf[EVP_MAX_MD_SIZE];
+
+  // Complete the chunk carried over from the previous call first.
+  if (!state.carry.empty()) {
+    const size_t fill =
+        std::min(TREE_CHUNK_LEN - state.carry.size(), data_len);
+    state.carry.insert(state.carry.end(), data, data + fill);
+    data += fill;
+    data_len -= fill;
+    if (state.carry.size() < TREE_CHUNK_LEN) {
+      return true;
+    }
+    if (!tree_hash(md, ctx, TREE_LEAF_PREFIX, &state.carry[0],
+                   TREE_CHUNK_LEN, nullptr, 0, leaf) ||
+        !tree_push_leaf(state, md, ctx, leaf)) {
+      return false;
+    }
+    state.carry.clear();
+  }
+
+  // Hash the whole chunks in place, in parallel, and stack them in order.
+  tree_leaf_job job;
+  job.md = md;
+  job.data = data;
+  job.num_chunks = data_len / TREE_CHUNK_LEN;
+  if (job.num_chunks) {
+    std::vector<unsigned char> leaves(job.num_chunks * md_len);
+    job.num_tasks = std::min(job.num_chunks, num_threads ? num_threads : 1);
+    job.leaves = &leaves[0];
+    job.ok.resize(job.num_tasks);
+    openssl_thread_util::run_tasks(tree_leaf_task, &job, job.num_tasks,
+                                   num_threads);
+    for (size_t task = 0; task < job.num_tasks; ++task) {
+      if (!job.ok[task]) {
+        return false;
+      }
+    }
+    for (size_t i = 0; i < job.num_chunks; ++i) {
+      if (!tree_push_leaf(state, md, ctx, &leaves[i * md_len])) {
+        return false;
+      }
+    }
+  }
+
+  const size_t whole = job.num_chunks * TREE_CHUNK_LEN;
+  state.carry.assign(data + whole, data + data_len);
+  return true;
+}
+
+bool tree_final(tree_state &state, const EVP_MD *md, EVP_MD_CTX *ctx,
+                unsigned char *digest) {
+  const size_t md_len = EVP_MD_size(md);
+  bool ok = true;
+
+  if (!state.carry.empty()) {
+    unsigned char leaf[EVP_MAX_MD_SIZE];
+    ok = tree_hash(md, ctx, TREE_LEAF_PREFIX, &state.carry[0],
+                   state.carry.size(), nullptr, 0, leaf) &&
+         tree_push_leaf(state, md, ctx, leaf);
+  }
+
+  if (ok && state.roots.empty()) {
+    // The hash of an empty input is that of no data at all.
+    ok = (1 == EVP_DigestInit_ex(ctx, md, nullptr) &&
+          1 == EVP_DigestFinal_ex(ctx, digest, nullptr));
+  } else if (ok) {
+    // Fold the subtrees from the smallest one; each is the right sibling
+    // of the next larger one.
+    size_t n = state.root_leaves.size();
+    memcpy(digest, &state.roots[(n - 1) * md_len], md_len);
+    for (--n; ok && n > 0; --n) {
+      ok = tree_hash(md, ctx, TREE_NODE_PREFIX, &state.roots[(n - 1) * md_len],
+                     md_len, digest, md_len, digest);
+    }
+  }
+
+  state = tree_state();
+  return ok;
+}
+
+// =====================================================================
+// Low level SHA-1 and SHA-2 with exportable state.
+// =====================================================================
+
+#ifndef OPENSSL_NO_DEPRECATED_3_0
+
+struct sha_state {
+  int nid;
+  union {
+    SHA_CTX sha1;
+    SHA256_CTX sha256;
+    SHA512_CTX sha512;
+  } ctx;
+};
+
+// Header of an exported state: magic, version, algorithm and buffered
+// length, followed by the number of bytes hashed.
+static const unsigned char SHA_STATE_MAGIC[4] = {'C', 'D', 'S', 1};
+static const size_t SHA_STATE_HEADER_LEN = 14;
+
+//@{
+// @brief How an algorithm is exported.
+//@}
+struct sha_format {
+  int nid;
+  unsigned char id;   // Algorithm in the exported state.
+  size_t block_len;   // Length of a block.
+  size_t word_len;    // Length of a word of the chaining value.
+  size_t state_words; // Words of the chaining value.
+};
+
+static const sha_format sha_formats[] = {{NID_sha1, 1, 64, 4, 5},
+                                         {NID_sha224, 2, 64, 4, 8},
+                                         {NID_sha256, 3, 64, 4, 8},
+                                         {NID_sha384, 4, 128, 8, 8},
+                                         {NID_sha512, 5, 128, 8, 8}};
+
+static const sha_format *get_sha_format(int nid) {
+  for (size_t i = 0; i < sizeof(sha_formats) / sizeof(sha_formats[0]); ++i) {
+    if (sha_formats[i].nid == nid) {
+      return &sha_formats[i];
+    }
+  }
+  return nullptr;
+}
+
+static void store_be(unsigned char *p, uint64_t v, size_t len) {
+  for (size_t i = len; i > 0; --i, v >>= 8) {
+    p[i - 1] = static_cast<unsigned char>(v);
+  }
+}
+
+static uint64_t load_be(const unsigned char *p, size_t len) {
+  uint64_t v = 0;
+  for (size_t i = 0; i < len; ++i) {
+    v = (v << 8) | p[i];
+  }
+  return v;
+}
+
+sha_state *sha_new(int nid) {
+  if (!get_sha_format(nid)) {
+    return nullptr;
+  }
+  sha_state *const state = new sha_state();
+  state->nid = nid;
+  return state;
+}
+
+void sha_free(sha_state *state) { delete state; }
+
+void sha_copy(sha_state &dst, const sha_state &src) { dst = src; }
+
+bool sha_init(sha_state &state) {
+  switch (state.nid) {
+  case NID_sha1:
+    return (1 == SHA1_Init(&state.ctx.sha1));
+  case NID_sha224:
+    return (1 == SHA224_Init(&state.ctx.sha256));
+  case NID_sha256:
+    return (1 == SHA256_Init(&state.ctx.sha256));
+  case NID_sha384:
+    return (1 == SHA384_Init(&state.ctx.sha512));
+  case NID_sha512:
+    return (1 == SHA512_Init(&state.ctx.sha512));
+  default:
+    return false;
+  }
+}
+
+bool sha_update(sha_state &state, const unsigned char *data,
+                size_t data_len) {
+  switch (state.nid) {
+  case NID_sha1:
+    return (1 == SHA1_Update(&state.ctx.sha1, data, data_len));
+  case NID_sha224:
+  case NID_sha256:
+    // SHA-224 shares the update of SHA-256, as SHA-384 that of SHA-512.
+    return (1 == SHA256_Update(&state.ctx.sha256, data, data_len));
+  case NID_sha384:
+  case NID_sha512:
+    return (1 == SHA512_Update(&state.ctx.sha512, data, data_len));
+  default:
+    return false;
+  }
+}
+
+bool sha_final(sha_state &state, unsigned char *digest) {
+  switch (state.nid) {
+  case NID_sha1:
+    return (1 == SHA1_Final(digest, &state.ctx.sha1));
+  case NID_sha224:
+  case NID_sha256:
+    return (1 == SHA256_Final(digest, &state.ctx.sha256));
+  case NID_sha384:
+  case NID_sha512:
+    return (1 == SHA512_Final(digest, &state.ctx.sha512));
+  default:
+    return false;
+  }
+}
+
+size_t sha_export(const sha_state &state, unsigned char *buf,
+                  size_t buf_len) {
+  const sha_format &format = *get_sha_format(state.nid);
+  uint64_t chain[8];
+  uint64_t bits;
+  size_t num;
+  const unsigned char *data;
+
+  if (state.nid == NID_sha1) {
+    const SHA_CTX &c = state.ctx.sha1;
+    const SHA_LONG h[5] = {c.h0, c.h1, c.h2, c.h3, c.h4};
+    for (size_t i = 0; i < 5; ++i) {
+      chain[i] = h[i];
+    }
+    bits = (static_cast<uint64_t>(c.Nh) << 32) | c.Nl;
+    num = c.num;
+    data = reinterpret_cast<const unsigned char *>(c.data);
+  } else if (format.word_len == 4) {
+    const SHA256_CTX &c = state.ctx.sha256;
+    for (size_t i = 0; i < 8; ++i) {
+      chain[i] = c.h[i];
+    }
+    bits = (static_cast<uint64_t>(c.Nh) << 32) | c.Nl;
+    num = c.num;
+    data = reinterpret_cast<const unsigned char *>(c.data);
+  } else {
+    const SHA512_CTX &c = state.ctx.sha512;
+    if (c.Nh) {
+      return 0;
+    }
+    for (size_t i = 0; i < 8; ++i) {
+      chain[i] = c.h[i];
+    }
+    bits = c.Nl;
+    num = c.num;
+    data = c.u.p;
+  }
+
+  const size_t chain_len = format.word_len * format.state_words;
+  const size_t len = SHA_STATE_HEADER_LEN + chain_len + num;
+  if (buf_len < len) {
+    return 0;
+  }
+
+  memcpy(buf, SHA_STATE_MAGIC, sizeof(SHA_STATE_MAGIC));
+  buf[4] = format.id;
+  buf[5] = static_cast<unsigned char>(num);
+  store_be(buf + 6, bits >> 3, 8);
+  unsigned char *p = buf + SHA_STATE_HEADER_LEN;
+  for (size_t i = 0; i < format.state_words; ++i, p += format.word_len) {
+    store_be(p, chain[i], format.word_len);
+  }
+  memcpy(p, data, num);
+  return len;
+}
+
+int sha_state_nid(const unsigned char *buf, size_t buf_len) {
+  if (buf_len < SHA_STATE_HEADER_LEN ||
+      memcmp(buf, SHA_STATE_MAGIC, sizeof(SHA_STATE_MAGIC))) {
+    return NID_undef;
+  }
+  for (size_t i = 0; i < sizeof(sha_formats) / sizeof(sha_formats[0]); ++i) {
+    if (sha_formats[i].id == buf[4]) {
+      return sha_formats[i].nid;
+    }
+  }
+  return NID_undef;
+}
+
+bool sha_import(sha_state &state, const unsigned char *buf, size_t buf_len) {
+  const sha_format &format = *get_sha_format(state.nid);
+  if (sha_state_nid(buf, buf_len) != state.nid) {
+    return false;
+  }
+
+  const size_t num = buf[5];
+  const uint64_t total = load_be(buf + 6, 8);
+  const size_t chain_len = format.word_len * format.state_words;
+  if (num >= format.block_len || total % format.block_len != num ||
+      total >> 61 || buf_len != SHA_STATE_HEADER_LEN + chain_len + num) {
+    return false;
+  }
+
+  uint64_t chain[8];
+  const unsigned char *p = buf + SHA_STATE_HEADER_LEN;
+  for (size_t i = 0; i < format.state_words; ++i, p += format.word_len) {
+    chain[i] = load_be(p, format.word_len);
+  }
+
+  // Initialize for the fields not exported, then restore the others.
+  if (!sha_init(state)) {
+    return false;
+  }
+  const uint64_t bits = total << 3;
+  if (state.nid == NID_sha1) {
+    SHA_CTX &c = state.ctx.sha1;
+    c.h0 = static_cast<SHA_LONG>(chain[0]);
+    c.h1 = static_cast<SHA_LONG>(chain[1]);
+    c.h2 = static_cast<SHA_LONG>(chain[2]);
+    c.h3 = static_cast<SHA_LONG>(chain[3]);
+    c.h4 = static_cast<SHA_LONG>(chain[4]);
+    c.Nl = static_cast<SHA_LONG>(bits);
+    c.Nh = static_cast<SHA_LONG>(bits >> 32);
+    c.num = num;
+    memcpy(c.data, p, num);
+  } else if (format.word_len == 4) {
+    SHA256_CTX &c = state.ctx.sha256;
+    for (size_t i = 0; i < 8; ++i) {
+      c.h[i] = static_cast<SHA_LONG>(chain[i]);
+    }
+    c.Nl = static_cast<SHA_LONG>(bits);
+    c.Nh = static_cast<SHA_LONG>(bits >> 32);
+    c.num = num;
+    memcpy(c.data, p, num);
+  } else {
+    SHA512_CTX &c = state.ctx.sha512;
+    for (size_t i = 0; i < 8; ++i) {
+      c.h[i] = chain[i];
+    }
+    c.Nl = bits;
+    c.Nh = 0;
+    c.num = num;
+    memcpy(c.u.p, p, num);
+  }
+  return true;
+}
+
+#else // OPENSSL_NO_DEPRECATED_3_0
+
+// Without the low level contexts there is nothing to export.
+struct sha_state {};
+
+sha_state *sha_new(int /* nid */) { return nullptr; }
+void sha_free(sha_state * /* state */) {}
+void sha_copy(sha_state & /* dst */, const sha_state & /* src */) {}
+bool sha_init(sha_state & /* state */) { return false; }
+bool sha_update(sha_state & /* state */, const unsigned char * /* data */,
+                size_t /* data_len */) {
+  return false;
+}
+bool sha_final(sha_state & /* state */, unsigned char * /* digest */) {
+  return false;
+}
+size_t sha_export(const sha_state & /* state */, unsigned char * /* buf */,
+                  size_t /* buf_len */) {
+  return 0;
+}
+int sha_state_nid(const unsigned char * /* buf */, size_t /* buf_len */) {
+  return NID_undef;
+}
+bool sha_import(sha_state & /* state */, const unsigned char * /* buf */,
+                size_t /* buf_len */) {
+  return false;
+}
+
+#endif // OPENSSL_NO_DEPRECATED_3_0
+
+} // namespace openssl_digest_util
+
+} // namespace cryptcpp
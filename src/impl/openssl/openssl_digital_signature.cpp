@@ -10,16 +10,27 @@
 #include <cryptcpp/impl/openssl/openssl_digital_signature.hpp>
 #include <cryptcpp/impl/openssl/openssl_exception.hpp>
 #include <cryptcpp/impl/openssl/openssl_key_util.hpp>
+#include <cryptcpp/impl/openssl/openssl_thread_util.hpp>
 
+#include <openssl/err.h>
 #include <openssl/evp.h>
 #include <openssl/pem.h>
+#include <algorithm>
+#include <vector>
 
 namespace cryptcpp {
 
 openssl_digital_signature::openssl_digital_signature()
-    : _M_md(EVP_sha256()), _M_key(nullptr) {}
+    : _M_md(EVP_sha256()), _M_key(nullptr), _M_sign_init_ctx(nullptr),
+      _M_verify_init_ctx(nullptr), _M_op_ctx(nullptr), _M_stream_ctx(nullptr),
+      _M_stream(STREAM_NONE) {}
 
 openssl_digital_signature::~openssl_digital_signature() {
+  reset_init_ctxs();
+  if (_M_op_ctx)
+    EVP_MD_CTX_free(_M_op_ctx);
+  if (_M_stream_ctx)
+    EVP_MD_CTX_free(_M_stream_ctx);
   if (_M_key)
     EVP_PKEY_free(_M_key);
 }
@@ -30,13 +41,7 @@ bool openssl_digital_signature::update_key(EVP_PKEY *pkey) {
     return false;
   }
 
-  int type = EVP_PKEY_id(pkey);
-  if (type == EVP_PKEY_ED25519 || type == EVP_PKEY_ED448) {
-    EVP_PKEY_free(pkey);
-    report_exception(openssl_exception("Key type not supported:"));
-    return false;
-  }
-
+  reset_init_ctxs();
   if (_M_key) {
     EVP_PKEY_free(_M_key);
   }
@@ -53,19 +58,91 @@ bool openssl_digital_signature::set_key(const char *file, key_type _key_type,
   return update_key(pkey);
 }
 
-EVP_MD_CTX *openssl_digital_signature::common_ctx_init() {
+const EVP_MD *openssl_digital_signature::get_sign_md() const {
+  const int type = EVP_PKEY_id(_M_key);
+  return ((type == EVP_PKEY_ED25519 || type == EVP_PKEY_ED448) ? nullptr
+                                                               : _M_md);
+}
+
+bool openssl_digital_signature::check_signs_digests() const {
+  if (!get_sign_md()) {
+    report_exception(openssl_exception(
+        "openssl_digital_signature: Not supported with EdDSA keys"));
+    return false;
+  }
+  return true;
+}
+
+EVP_MD_CTX *openssl_digital_signature::get_init_ctx(bool for_sign) const {
+  EVP_MD_CTX *&init_ctx = for_sign ? _M_sign_init_ctx : _M_verify_init_ctx;
+  if (init_ctx) {
+    return init_ctx;
+  }
+
   if (!_M_key) {
     report_exception(
         openssl_exception("openssl_digital_signature: Key not set"));
     return nullptr;
   }
 
-  EVP_MD_CTX *mdctx = EVP_MD_CTX_new();
+  cryptcpp_unique_ptr<EVP_MD_CTX> mdctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
   if (!mdctx) {
     report_exception(openssl_exception("EVP_MD_CTX_new:"));
     return nullptr;
   }
-  return mdctx;
+
+  // Key setup such as that of the RSA Montgomery and blinding state is
+  // done here, once. EdDSA keys are initialized without a digest
+  // algorithm.
+  if (for_sign) {
+    if (1 != EVP_DigestSignInit(mdctx.get(), nullptr, get_sign_md(), nullptr,
+                                _M_key)) {
+      report_exception(openssl_exception("EVP_DigestSignInit:"));
+      return nullptr;
+    }
+  } else {
+    if (1 != EVP_DigestVerifyInit(mdctx.get(), nullptr, get_sign_md(),
+                                  nullptr, _M_key)) {
+      report_exception(openssl_exception("EVP_DigestVerifyInit:"));
+      return nullptr;
+    }
+  }
+
+  init_ctx = mdctx.release();
+  return init_ctx;
+}
+
+bool openssl_digital_signature::common_ctx_init(bool for_sign,
+                                                EVP_MD_CTX *&ctx) {
+  EVP_MD_CTX *const init_ctx = get_init_ctx(for_sign);
+  if (!init_ctx) {
+    return false;
+  }
+
+  if (!ctx) {
+    ctx = EVP_MD_CTX_new();
+    if (!ctx) {
+      report_exception(openssl_exception("EVP_MD_CTX_new:"));
+      return false;
+    }
+  }
+
+  if (1 != EVP_MD_CTX_copy_ex(ctx, init_ctx)) {
+    report_exception(openssl_exception("EVP_MD_CTX_copy_ex:"));
+    return false;
+  }
+  return true;
+}
+
+void openssl_digital_signature::reset_init_ctxs() {
+  if (_M_sign_init_ctx) {
+    EVP_MD_CTX_free(_M_sign_init_ctx);
+    _M_sign_init_ctx = nullptr;
+  }
+  if (_M_verify_init_ctx) {
+    EVP_MD_CTX_free(_M_verify_init_ctx);
+    _M_verify_init_ctx = nullptr;
+  }
 }
 
 size_t openssl_digital_signature::sign(const unsigned char *digest,
@@ -73,37 +150,199 @@ size_t openssl_digital_signature::sign(const unsigned char *digest,
                                        unsigned char *sign_buf,
                                        size_t sign_buf_len) {
 
-  cryptcpp_unique_ptr<EVP_MD_CTX> mdctx(common_ctx_init(), EVP_MD_CTX_free);
-  if (!mdctx) {
+  if (!common_ctx_init(true, _M_op_ctx)) {
+    return 0;
+  }
+
+  /* First call EVP_DigestSign with a null sig parameter to obtain the
+   * signature length. */
+  size_t sign_len = sign_buf_len;
+  if (1 != EVP_DigestSign(_M_op_ctx, nullptr, &sign_len, digest,
+                          digest_len)) {
+    report_exception(openssl_exception("EVP_DigestSign:"));
     return 0;
   }
 
-  if (1 != EVP_DigestSignInit(mdctx.get(), nullptr, _M_md, nullptr, _M_key)) {
-    report_exception(openssl_exception("EVP_DigestSignInit:"));
+  if (sign_buf_len < sign_len) {
+    report_exception(openssl_exception(
+        "openssl_digital_signature::sign: Insufficient buffer length"));
     return 0;
   }
 
-  if (1 != EVP_DigestSignUpdate(mdctx.get(), digest, digest_len)) {
+  /* Now sign in one pass, as EdDSA requires. */
+  if (1 != EVP_DigestSign(_M_op_ctx, sign_buf, &sign_len, digest,
+                          digest_len)) {
+    report_exception(openssl_exception("EVP_DigestSign:"));
+    return 0;
+  }
+
+  return sign_len;
+}
+
+bool openssl_digital_signature::verify(const unsigned char *digest,
+                                       size_t digest_len,
+                                       const unsigned char *signature,
+                                       size_t sign_len) {
+
+  if (!common_ctx_init(false, _M_op_ctx)) {
+    return false;
+  }
+
+  return (1 == EVP_DigestVerify(_M_op_ctx, signature, sign_len, digest,
+                                digest_len));
+}
+
+EVP_PKEY_CTX *openssl_digital_signature::common_pkey_ctx_init(
+    bool for_sign, size_t digest_len) {
+  if (!_M_key) {
+    report_exception(
+        openssl_exception("openssl_digital_signature: Key not set"));
+    return nullptr;
+  }
+
+  if (!check_signs_digests()) {
+    return nullptr;
+  }
+
+  if (digest_len != static_cast<size_t>(EVP_MD_size(_M_md))) {
+    report_exception(openssl_exception(
+        "openssl_digital_signature: Digest length mismatch"));
+    return nullptr;
+  }
+
+  cryptcpp_unique_ptr<EVP_PKEY_CTX> pctx(EVP_PKEY_CTX_new(_M_key, nullptr),
+                                         EVP_PKEY_CTX_free);
+  if (!pctx) {
+    report_exception(openssl_exception("EVP_PKEY_CTX_new:"));
+    return nullptr;
+  }
+
+  if (1 != (for_sign ? EVP_PKEY_sign_init(pctx.get())
+                     : EVP_PKEY_verify_init(pctx.get()))) {
+    report_exception(openssl_exception(for_sign ? "EVP_PKEY_sign_init:"
+                                                : "EVP_PKEY_verify_init:"));
+    return nullptr;
+  }
+
+  // The digest algorithm selects the DigestInfo of RSA signatures, so they
+  // match those of sign() over the data.
+  if (1 != EVP_PKEY_CTX_set_signature_md(pctx.get(), _M_md)) {
+    report_exception(openssl_exception("EVP_PKEY_CTX_set_signature_md:"));
+    return nullptr;
+  }
+
+  return pctx.release();
+}
+
+size_t openssl_digital_signature::sign_digest(const unsigned char *digest,
+                                              size_t digest_len,
+                                              unsigned char *sign_buf,
+                                              size_t sign_buf_len) {
+  cryptcpp_unique_ptr<EVP_PKEY_CTX> pctx(
+      common_pkey_ctx_init(true, digest_len), EVP_PKEY_CTX_free);
+  if (!pctx) {
+    return 0;
+  }
+
+  /* First call EVP_PKEY_sign with a null sig parameter to obtain the
+   * signature length. */
+  size_t sign_len = 0;
+  if (1 != EVP_PKEY_sign(pctx.get(), nullptr, &sign_len, digest, digest_len)) {
+    report_exception(openssl_exception("EVP_PKEY_sign:"));
+    return 0;
+  }
+
+  if (sign_buf_len < sign_len) {
+    report_exception(openssl_exception(
+        "openssl_digital_signature::sign_digest: Insufficient buffer length"));
+    return 0;
+  }
+
+  /* Now get the signature */
+  sign_len = sign_buf_len;
+  if (1 != EVP_PKEY_sign(pctx.get(), sign_buf, &sign_len, digest, digest_len)) {
+    report_exception(openssl_exception("EVP_PKEY_sign:"));
+    return 0;
+  }
+
+  return sign_len;
+}
+
+bool openssl_digital_signature::verify_digest(const unsigned char *digest,
+                                              size_t digest_len,
+                                              const unsigned char *signature,
+                                              size_t sign_len) {
+  cryptcpp_unique_ptr<EVP_PKEY_CTX> pctx(
+      common_pkey_ctx_init(false, digest_len), EVP_PKEY_CTX_free);
+  if (!pctx) {
+    return false;
+  }
+
+  return (1 == EVP_PKEY_verify(pctx.get(), signature, sign_len, digest,
+                               digest_len));
+}
+
+bool openssl_digital_signature::stream_init(bool for_sign) {
+  _M_stream = STREAM_NONE;
+  if (!_M_key) {
+    report_exception(
+        openssl_exception("openssl_digital_signature: Key not set"));
+    return false;
+  }
+
+  if (!check_signs_digests()) {
+    return false;
+  }
+
+  if (!common_ctx_init(for_sign, _M_stream_ctx)) {
+    return false;
+  }
+
+  _M_stream = for_sign ? STREAM_SIGN : STREAM_VERIFY;
+  return true;
+}
+
+bool openssl_digital_signature::sign_init() { return stream_init(true); }
+
+bool openssl_digital_signature::sign_update(const unsigned char *data,
+                                            size_t data_len) {
+  if (_M_stream != STREAM_SIGN) {
+    report_exception(
+        openssl_exception("openssl_digital_signature: Signing not started"));
+    return false;
+  }
+
+  if (1 != EVP_DigestSignUpdate(_M_stream_ctx, data, data_len)) {
     report_exception(openssl_exception("EVP_DigestSignUpdate:"));
+    return false;
+  }
+  return true;
+}
+
+size_t openssl_digital_signature::sign_final(unsigned char *sign_buf,
+                                             size_t sign_buf_len) {
+  if (_M_stream != STREAM_SIGN) {
+    report_exception(
+        openssl_exception("openssl_digital_signature: Signing not started"));
     return 0;
   }
 
   /* First call EVP_DigestSignFinal with a null sig parameter to obtain the
-   * signature length. */
+   * signature length; the stream goes on. */
   size_t sign_len = sign_buf_len;
-  if (1 != EVP_DigestSignFinal(mdctx.get(), nullptr, &sign_len)) {
+  if (1 != EVP_DigestSignFinal(_M_stream_ctx, nullptr, &sign_len)) {
     report_exception(openssl_exception("EVP_DigestSignFinal:"));
     return 0;
   }
 
   if (sign_buf_len < sign_len) {
     report_exception(openssl_exception(
-        "openssl_digital_signature::sign: Insufficient buffer length"));
+        "openssl_digital_signature::sign_final: Insufficient buffer length"));
     return 0;
   }
 
-  /* Now get the signature */
-  if (1 != EVP_DigestSignFinal(mdctx.get(), sign_buf, &sign_len)) {
+  _M_stream = STREAM_NONE;
+  if (1 != EVP_DigestSignFinal(_M_stream_ctx, sign_buf, &sign_len)) {
     report_exception(openssl_exception("EVP_DigestSignFinal:"));
     return 0;
   }
@@ -111,27 +350,107 @@ size_t openssl_digital_signature::sign(const unsigned char *digest,
   return sign_len;
 }
 
-bool openssl_digital_signature::verify(const unsigned char *digest,
-                                       size_t digest_len,
-                                       const unsigned char *signature,
-                                       size_t sign_len) {
+bool openssl_digital_signature::verify_init() { return stream_init(false); }
 
-  cryptcpp_unique_ptr<EVP_MD_CTX> mdctx(common_ctx_init(), EVP_MD_CTX_free);
-  if (!mdctx) {
-    return 0;
+bool openssl_digital_signature::verify_update(const unsigned char *data,
+                                              size_t data_len) {
+  if (_M_stream != STREAM_VERIFY) {
+    report_exception(openssl_exception(
+        "openssl_digital_signature: Verification not started"));
+    return false;
   }
 
-  if (1 != EVP_DigestVerifyInit(mdctx.get(), nullptr, _M_md, nullptr, _M_key)) {
-    report_exception(openssl_exception("EVP_DigestVerifyInit:"));
+  if (1 != EVP_DigestVerifyUpdate(_M_stream_ctx, data, data_len)) {
+    report_exception(openssl_exception("EVP_DigestVerifyUpdate:"));
     return false;
   }
+  return true;
+}
 
-  if (1 != EVP_DigestVerifyUpdate(mdctx.get(), digest, digest_len)) {
-    report_exception(openssl_exception("EVP_DigestVerifyInit:"));
+bool openssl_digital_signature::verify_final(const unsigned char *signature,
+                                             size_t sign_len) {
+  if (_M_stream != STREAM_VERIFY) {
+    report_exception(openssl_exception(
+        "openssl_digital_signature: Verification not started"));
     return false;
   }
 
-  return (1 == EVP_DigestVerifyFinal(mdctx.get(), signature, sign_len));
+  _M_stream = STREAM_NONE;
+  return (1 == EVP_DigestVerifyFinal(_M_stream_ctx, signature, sign_len));
+}
+
+// A multi-threaded verification job; every task verifies a run of
+// messages on the context of its thread, copied for each message from
+// the verifier's initialized one.
+struct verify_batch_job {
+  const unsigned char *const *data;
+  const size_t *data_lens;
+  const unsigned char *const *signatures;
+  const size_t *sign_lens;
+  std::vector<const EVP_MD_CTX *> init_ctxs;
+  size_t num_tasks;
+  bool *results;
+};
+
+static void verify_batch_task(void *ctx, size_t task) {
+  verify_batch_job &job = *static_cast<verify_batch_job *>(ctx);
+  const size_t count = job.init_ctxs.size();
+  const size_t first = count * task / job.num_tasks;
+  const size_t last = count * (task + 1) / job.num_tasks;
+
+  EVP_MD_CTX *const mdctx = openssl_thread_util::get_thread_md_ctx();
+  for (size_t i = first; i < last; ++i) {
+    job.results[i] =
+        mdctx && 1 == EVP_MD_CTX_copy_ex(mdctx, job.init_ctxs[i]) &&
+        1 == EVP_DigestVerify(mdctx, job.signatures[i], job.sign_lens[i],
+                              job.data[i], job.data_lens[i]);
+  }
+  // Do not hold on to the last key between batches.
+  if (mdctx)
+    EVP_MD_CTX_reset(mdctx);
+
+  // A signature that does not verify is a result, not an error.
+  ERR_clear_error();
+}
+
+size_t openssl_digital_signature::verify_batch(
+    size_t count, const unsigned char *const *data, const size_t *data_lens,
+    const unsigned char *const *signatures, const size_t *sign_lens,
+    const digital_signature *const *verifiers, bool *results) {
+  // Resolve the initialized verification context of every message up
+  // front on the calling thread, so that the workers only copy them.
+  verify_batch_job job;
+  job.data = data;
+  job.data_lens = data_lens;
+  job.signatures = signatures;
+  job.sign_lens = sign_lens;
+  job.results = results;
+  job.init_ctxs.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const openssl_digital_signature *verifier = this;
+    if (verifiers && verifiers[i]) {
+      verifier =
+          dynamic_cast<const openssl_digital_signature *>(verifiers[i]);
+    }
+    if (!verifier || !verifier->_M_key) {
+      report_exception(openssl_exception(
+          "openssl_digital_signature::verify_batch: Key not set"));
+      return 0;
+    }
+    job.init_ctxs[i] = verifier->get_init_ctx(false);
+    if (!job.init_ctxs[i]) {
+      return 0;
+    }
+  }
+
+  if (!count) {
+    return 0;
+  }
+  job.num_tasks = std::min(count, _M_num_threads);
+  openssl_thread_util::run_tasks(verify_batch_task, &job, job.num_tasks,
+                                 _M_num_threads);
+
+  return static_cast<size_t>(std::count(results, results + count, true));
 }
 
 bool openssl_digital_signature::set_digest_algo(
@@ -142,6 +461,9 @@ bool openssl_digital_signature::set_digest_algo(
     return false;
   }
 
+  if (eMd != _M_md) {
+    reset_init_ctxs();
+  }
   _M_md = eMd;
   return true;
 }
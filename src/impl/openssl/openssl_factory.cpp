@@ -9,10 +9,14 @@
 #include <cryptcpp/impl/openssl/openssl_factory.hpp>
 
 #include <cryptcpp/impl/openssl/openssl_asymmetric_key_crypt.hpp>
+#include <cryptcpp/impl/openssl/openssl_codec_base32.hpp>
+#include <cryptcpp/impl/openssl/openssl_codec_base58.hpp>
 #include <cryptcpp/impl/openssl/openssl_codec_base64.hpp>
 #include <cryptcpp/impl/openssl/openssl_codec_hex.hpp>
 #include <cryptcpp/impl/openssl/openssl_digest.hpp>
 #include <cryptcpp/impl/openssl/openssl_digital_signature.hpp>
+#include <cryptcpp/impl/openssl/openssl_mac.hpp>
+#include <cryptcpp/impl/openssl/openssl_multi_digest.hpp>
 #include <cryptcpp/impl/openssl/openssl_symmetric_key_crypt.hpp>
 
 namespace cryptcpp {
@@ -30,11 +34,21 @@ codec *openssl_factory::create_codec(codec::codec_algorithm codec_algo) const {
   switch (codec_algo) {
   case codec::CODEC_BASE64:
   case codec::CODEC_BASE64_NL:
+  case codec::CODEC_BASE64URL:
+  case codec::CODEC_BASE64_NOPAD:
     return new openssl_codec_base64(codec_algo);
 
   case codec::CODEC_HEX:
+  case codec::CODEC_HEX_LOWER:
     return new openssl_codec_hex(codec_algo);
 
+  case codec::CODEC_BASE32:
+  case codec::CODEC_BASE32HEX:
+    return new openssl_codec_base32(codec_algo);
+
+  case codec::CODEC_BASE58:
+    return new openssl_codec_base58(codec_algo);
+
   default:
     return nullptr;
   }
@@ -46,6 +60,12 @@ digital_signature *openssl_factory::create_digital_signature() const {
 
 digest *openssl_factory::create_digest() const { return new openssl_digest(); }
 
+multi_digest *openssl_factory::create_multi_digest() const {
+  return new openssl_multi_digest();
+}
+
+mac *openssl_factory::create_mac() const { return new openssl_mac(); }
+
 asymmetric_key_crypt *openssl_factory::create_asymmetric_key_crypt() const {
   return new openssl_asymmetric_key_crypt();
 }
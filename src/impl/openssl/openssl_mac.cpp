@@ -0,0 +1,226 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cryptcpp/cryptcpp_util.hpp>
+#include <cryptcpp/impl/openssl/openssl_exception.hpp>
+#include <cryptcpp/impl/openssl/openssl_mac.hpp>
+
+#include <openssl/evp.h>
+#include <string.h>
+#include <string>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#endif
+
+namespace cryptcpp {
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+
+// Prefix of the names of the HMAC algorithms, followed by the digest.
+static const char HMAC_PREFIX[] = "HMAC-";
+
+openssl_mac::openssl_mac()
+    : _M_ctx(nullptr), _M_keyed(false), _M_one_time(false),
+      _M_key_used(false) {}
+
+openssl_mac::~openssl_mac() {
+  if (_M_ctx)
+    EVP_MAC_CTX_free(_M_ctx);
+}
+
+bool openssl_mac::set_mac_algorithm(mac_algorithm mac_algo) {
+  std::string mac_name(mac_algo);
+  std::string digest_name;
+  if (0 == strncmp(mac_algo, HMAC_PREFIX, sizeof(HMAC_PREFIX) - 1)) {
+    digest_name = mac_name.substr(sizeof(HMAC_PREFIX) - 1);
+    mac_name = "HMAC";
+  }
+
+  EVP_MAC *const evp_mac = EVP_MAC_fetch(nullptr, mac_name.c_str(), nullptr);
+  if (!evp_mac) {
+    report_exception(openssl_exception("Unsupported MAC Algorithm:"));
+    return false;
+  }
+  // The context keeps its own reference to the algorithm.
+  const bool one_time = EVP_MAC_is_a(evp_mac, "POLY1305");
+  EVP_MAC_CTX *const ctx = EVP_MAC_CTX_new(evp_mac);
+  EVP_MAC_free(evp_mac);
+  if (!ctx) {
+    report_exception(openssl_exception("EVP_MAC_CTX_new:"));
+    return false;
+  }
+
+  if (!digest_name.empty()) {
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+                                         &digest_name[0], 0),
+        OSSL_PARAM_construct_end()};
+    if (1 != EVP_MAC_CTX_set_params(ctx, params)) {
+      EVP_MAC_CTX_free(ctx);
+      report_exception(openssl_exception("Unsupported MAC Algorithm:"));
+      return false;
+    }
+  }
+
+  if (_M_ctx)
+    EVP_MAC_CTX_free(_M_ctx);
+  _M_ctx = ctx;
+  _M_keyed = false;
+  _M_one_time = one_time;
+  return true;
+}
+
+bool openssl_mac::set_key(const unsigned char *key, size_t key_len) {
+  if (!_M_ctx) {
+    report_exception(openssl_exception("openssl_mac: MAC algo not set"));
+    return false;
+  }
+
+  // Keying derives the state every calculation restarts from.
+  _M_keyed = false;
+  if (1 != EVP_MAC_init(_M_ctx, key, key_len, nullptr)) {
+    report_exception(openssl_exception("EVP_MAC_init:"));
+    return false;
+  }
+  _M_keyed = true;
+  _M_key_used = false;
+  return true;
+}
+
+size_t openssl_mac::get_mac_len() const {
+  return (_M_ctx ? EVP_MAC_CTX_get_mac_size(_M_ctx) : 0);
+}
+
+bool openssl_mac::init() {
+  if (!_M_keyed) {
+    report_exception(openssl_exception("openssl_mac: Key not set"));
+    return false;
+  }
+
+  // Restarting a one-time authenticator would reuse its key.
+  if (_M_one_time && _M_key_used) {
+    report_exception(openssl_exception(
+        "openssl_mac::init: Poly1305 must be re-keyed per message"));
+    return false;
+  }
+
+  // Without a key the context restarts from the keyed state.
+  if (1 != EVP_MAC_init(_M_ctx, nullptr, 0, nullptr)) {
+    report_exception(openssl_exception("EVP_MAC_init:"));
+    return false;
+  }
+  _M_key_used = true;
+  return true;
+}
+
+bool openssl_mac::update(const unsigned char *data, size_t data_len) {
+  if (!_M_keyed || 1 != EVP_MAC_update(_M_ctx, data, data_len)) {
+    report_exception(openssl_exception("EVP_MAC_update:"));
+    return false;
+  }
+  return true;
+}
+
+size_t openssl_mac::final(unsigned char *mac_buf, size_t mac_buf_len) {
+  if (!_M_keyed) {
+    report_exception(openssl_exception("openssl_mac: Key not set"));
+    return 0;
+  }
+
+  if (mac_buf_len < get_mac_len()) {
+    report_exception(
+        openssl_exception("openssl_mac::final: Insufficient buffer length"));
+    return 0;
+  }
+
+  size_t mac_len = 0;
+  if (1 != EVP_MAC_final(_M_ctx, mac_buf, &mac_len, mac_buf_len)) {
+    report_exception(openssl_exception("EVP_MAC_final:"));
+    return 0;
+  }
+  return mac_len;
+}
+
+#else // OPENSSL_VERSION_NUMBER
+
+openssl_mac::openssl_mac()
+    : _M_keyed(false), _M_one_time(false), _M_key_used(false) {}
+
+openssl_mac::~openssl_mac() {}
+
+bool openssl_mac::set_mac_algorithm(mac_algorithm /* mac_algo */) {
+  report_exception(openssl_exception("Unsupported MAC Algorithm:"));
+  return false;
+}
+
+bool openssl_mac::set_key(const unsigned char * /* key */,
+                          size_t /* key_len */) {
+  report_exception(openssl_exception("openssl_mac: MAC algo not set"));
+  return false;
+}
+
+size_t openssl_mac::get_mac_len() const { return 0; }
+
+bool openssl_mac::init() {
+  report_exception(openssl_exception("openssl_mac: Key not set"));
+  return false;
+}
+
+bool openssl_mac::update(const unsigned char * /* data */,
+                         size_t /* data_len */) {
+  report_exception(openssl_exception("openssl_mac: Key not set"));
+  return false;
+}
+
+size_t openssl_mac::final(unsigned char * /* mac_buf */,
+                          size_t /* mac_buf_len */) {
+  report_exception(openssl_exception("openssl_mac: Key not set"));
+  return 0;
+}
+
+#endif // OPENSSL_VERSION_NUMBER
+
+size_t openssl_mac::calculate_mac(const unsigned char *data, size_t data_len,
+                                  unsigned char *mac_buf, size_t mac_buf_len) {
+  if (!init() || !update(data, data_len)) {
+    return 0;
+  }
+  return final(mac_buf, mac_buf_len);
+}
+
+size_t openssl_mac::calculate_mac_batch(size_t count,
+                                        const unsigned char *const *data,
+                                        const size_t *data_lens,
+                                        unsigned char *mac_buf,
+                                        size_t mac_buf_len) {
+  if (_M_one_time) {
+    report_exception(openssl_exception(
+        "openssl_mac::calculate_mac_batch: Poly1305 must be re-keyed per "
+        "message"));
+    return 0;
+  }
+
+  const size_t mac_len = get_mac_len();
+  if (!mac_len || mac_buf_len / mac_len < count) {
+    report_exception(openssl_exception(
+        "openssl_mac::calculate_mac_batch: Insufficient buffer length"));
+    return 0;
+  }
+
+  // Every message restarts from the keyed state.
+  for (size_t i = 0; i < count; ++i) {
+    if (!calculate_mac(data[i], data_lens[i], mac_buf + i * mac_len,
+                       mac_len)) {
+      return 0;
+    }
+  }
+  return (count * mac_len);
+}
+
+} // namespace cryptcpp
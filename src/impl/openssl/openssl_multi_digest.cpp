@@ -0,0 +1,134 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cryptcpp/cryptcpp_util.hpp>
+#include <cryptcpp/impl/openssl/openssl_digest.hpp>
+#include <cryptcpp/impl/openssl/openssl_exception.hpp>
+#include <cryptcpp/impl/openssl/openssl_multi_digest.hpp>
+
+namespace cryptcpp {
+
+// Length of the chunks fed to every digest in turn, well within the L1
+// data cache so that only the first digest reads a chunk from memory.
+static const size_t MULTI_DIGEST_CHUNK_LEN = 16 * 1024;
+
+openssl_multi_digest::openssl_multi_digest() {}
+
+openssl_multi_digest::~openssl_multi_digest() { free_digests(_M_digests); }
+
+void openssl_multi_digest::free_digests(
+    std::vector<openssl_digest *> &digests) {
+  for (size_t i = 0; i < digests.size(); ++i) {
+    delete digests[i];
+  }
+  digests.clear();
+}
+
+bool openssl_multi_digest::set_digest_algorithms(
+    const digest::digest_algorithm *digest_algos, size_t num_algos) {
+  std::vector<openssl_digest *> digests;
+  try {
+    for (size_t i = 0; i < num_algos; ++i) {
+      digests.push_back(new openssl_digest());
+      if (!digests.back()->set_digest_algorithm(digest_algos[i])) {
+        free_digests(digests);
+        return false;
+      }
+    }
+  } catch (...) {
+    free_digests(digests);
+    throw;
+  }
+
+  free_digests(_M_digests);
+  _M_digests.swap(digests);
+  return true;
+}
+
+size_t openssl_multi_digest::get_num_digests() const {
+  return _M_digests.size();
+}
+
+size_t openssl_multi_digest::get_digest_len(size_t index) const {
+  return ((index < _M_digests.size()) ? _M_digests[index]->get_digest_len()
+                                      : 0);
+}
+
+size_t openssl_multi_digest::get_digests_len() const {
+  size_t len = 0;
+  for (size_t i = 0; i < _M_digests.size(); ++i) {
+    len += _M_digests[i]->get_digest_len();
+  }
+  return len;
+}
+
+size_t openssl_multi_digest::calculate_digests(const unsigned char *data,
+                                               size_t data_len,
+                                               unsigned char *digest_buf,
+                                               size_t digest_buf_len) {
+  if (!init() || !update(data, data_len)) {
+    return 0;
+  }
+  return final(digest_buf, digest_buf_len);
+}
+
+bool openssl_multi_digest::init() {
+  if (_M_digests.empty()) {
+    report_exception(
+        openssl_exception("openssl_multi_digest: Digest algos not set"));
+    return false;
+  }
+
+  for (size_t i = 0; i < _M_digests.size(); ++i) {
+    if (!_M_digests[i]->init()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool openssl_multi_digest::update(const unsigned char *data,
+                                  size_t data_len) {
+  // Chunk by chunk rather than digest by digest, so that the data is
+  // still cached for all but the first digest.
+  while (data_len) {
+    const size_t len =
+        (data_len < MULTI_DIGEST_CHUNK_LEN) ? data_len : MULTI_DIGEST_CHUNK_LEN;
+    for (size_t i = 0; i < _M_digests.size(); ++i) {
+      if (!_M_digests[i]->update(data, len)) {
+        return false;
+      }
+    }
+    data += len;
+    data_len -= len;
+  }
+  return true;
+}
+
+size_t openssl_multi_digest::final(unsigned char *digest_buf,
+                                   size_t digest_buf_len) {
+  if (digest_buf_len < get_digests_len()) {
+    report_exception(openssl_exception(
+        "openssl_multi_digest::final: Insufficient buffer length"));
+    return 0;
+  }
+
+  size_t len = 0;
+  for (size_t i = 0; i < _M_digests.size(); ++i) {
+    // Extendable output functions are collected at their default length.
+    const size_t digest_len = _M_digests[i]->final(
+        digest_buf + len, _M_digests[i]->get_digest_len());
+    if (!digest_len) {
+      return 0;
+    }
+    len += digest_len;
+  }
+  return len;
+}
+
+} // namespace cryptcpp
@@ -0,0 +1,275 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License").  You may not use
+// this file except in compliance with the License.  You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cryptcpp/impl/openssl/openssl_thread_util.hpp>
+#include <algorithm>
+#include <deque>
+
+#if __cplusplus < 201100L
+#include <pthread.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#endif
+
+namespace cryptcpp {
+
+namespace openssl_thread_util {
+
+// A run_tasks() call in progress. It lives on the stack of the calling
+// thread, which takes tasks from it too, and is guarded by the pool mutex.
+struct pool_job {
+  task_func func;
+  void *ctx;
+  size_t num_tasks;
+  size_t next;        // next task to hand out
+  size_t done;        // tasks finished
+  size_t helpers;     // pool threads working on the job
+  size_t max_helpers; // pool threads the job may use
+};
+
+// The worker threads, started on demand and never stopped. The pool is
+// never destroyed either, so that idle workers do not outlive it at exit.
+struct pool {
+#if __cplusplus < 201100L
+  pthread_mutex_t mutex;
+  pthread_cond_t work;     // signalled when a job is queued
+  pthread_cond_t finished; // signalled when a job may be complete
+#else
+  std::mutex mutex;
+  std::condition_variable work;
+  std::condition_variable finished;
+#endif
+  std::deque<pool_job *> jobs;
+  size_t num_workers;
+};
+
+#if __cplusplus < 201100L
+static pool *the_pool = nullptr;
+static pthread_once_t the_pool_once = PTHREAD_ONCE_INIT;
+
+static void create_pool() {
+  the_pool = new pool;
+  pthread_mutex_init(&the_pool->mutex, nullptr);
+  pthread_cond_init(&the_pool->work, nullptr);
+  pthread_cond_init(&the_pool->finished, nullptr);
+  the_pool->num_workers = 0;
+}
+
+static pool &get_pool() {
+  pthread_once(&the_pool_once, create_pool);
+  return *the_pool;
+}
+
+// A scoped lock of the pool mutex that can wait on its conditions.
+class pool_lock {
+public:
+  explicit pool_lock(pool &p) : _M_pool(p) {
+    pthread_mutex_lock(&_M_pool.mutex);
+  }
+  ~pool_lock() { pthread_mutex_unlock(&_M_pool.mutex); }
+
+  void unlock() { pthread_mutex_unlock(&_M_pool.mutex); }
+  void lock() { pthread_mutex_lock(&_M_pool.mutex); }
+  void wait_work() { pthread_cond_wait(&_M_pool.work, &_M_pool.mutex); }
+  void wait_finished() {
+    pthread_cond_wait(&_M_pool.finished, &_M_pool.mutex);
+  }
+
+private:
+  pool &_M_pool;
+};
+
+static void notify_work(pool &p) { pthread_cond_broadcast(&p.work); }
+static void notify_finished(pool &p) { pthread_cond_broadcast(&p.finished); }
+#else
+static pool &get_pool() {
+  static pool *const the_pool = new pool();
+  return *the_pool;
+}
+
+// A scoped lock of the pool mutex that can wait on its conditions.
+class pool_lock {
+public:
+  explicit pool_lock(pool &p) : _M_pool(p), _M_lock(p.mutex) {}
+
+  void unlock() { _M_lock.unlock(); }
+  void lock() { _M_lock.lock(); }
+  void wait_work() { _M_pool.work.wait(_M_lock); }
+  void wait_finished() { _M_pool.finished.wait(_M_lock); }
+
+private:
+  pool &_M_pool;
+  std::unique_lock<std::mutex> _M_lock;
+};
+
+static void notify_work(pool &p) { p.work.notify_all(); }
+static void notify_finished(pool &p) { p.finished.notify_all(); }
+#endif
+
+static void remove_job(pool &p, pool_job *job) {
+  std::deque<pool_job *>::iterator it =
+      std::find(p.jobs.begin(), p.jobs.end(), job);
+  if (it != p.jobs.end()) {
+    p.jobs.erase(it);
+  }
+}
+
+// Runs the tasks of job still to be handed out. Called and returns with
+// the pool mutex held, which is released while a task runs.
+static void take_tasks(pool &p, pool_lock &lock, pool_job &job) {
+  while (job.next < job.num_tasks) {
+    const size_t task = job.next++;
+    if (job.next == job.num_tasks) {
+      remove_job(p, &job);
+    }
+    lock.unlock();
+    job.func(job.ctx, task);
+    lock.lock();
+    ++job.done;
+  }
+}
+
+// The first queued job that may use one more pool thread, or nullptr.
+static pool_job *find_job(pool &p) {
+  for (size_t i = 0; i < p.jobs.size(); ++i) {
+    if (p.jobs[i]->helpers < p.jobs[i]->max_helpers) {
+      return p.jobs[i];
+    }
+  }
+  return nullptr;
+}
+
+static void run_worker() {
+  pool &p = get_pool();
+  pool_lock lock(p);
+  for (;;) {
+    pool_job *const job = find_job(p);
+    if (!job) {
+      lock.wait_work();
+      continue;
+    }
+
+    ++job->helpers;
+    take_tasks(p, lock, *job);
+    --job->helpers;
+    // The caller may return, and the job go away, once this is seen.
+    if (!job->helpers && job->done == job->num_tasks) {
+      notify_finished(p);
+    }
+  }
+}
+
+#if __cplusplus < 201100L
+static void *posix_worker(void *) {
+  run_worker();
+  return nullptr;
+}
+
+static bool start_worker() {
+  pthread_t thread;
+  if (pthread_create(&thread, nullptr, posix_worker, nullptr) != 0) {
+    return false;
+  }
+  pthread_detach(thread);
+  return true;
+}
+#else
+static bool start_worker() {
+  try {
+    std::thread(run_worker).detach();
+  } catch (const std::system_error &) {
+    return false;
+  }
+  return true;
+}
+#endif
+
+void run_tasks(task_func func, void *ctx, size_t num_tasks,
+               size_t num_threads) {
+  if (num_threads > num_tasks) {
+    num_threads = num_tasks;
+  }
+  if (num_threads <= 1) {
+    for (size_t task = 0; task < num_tasks; ++task) {
+      func(ctx, task);
+    }
+    return;
+  }
+
+  pool_job job;
+  job.func = func;
+  job.ctx = ctx;
+  job.num_tasks = num_tasks;
+  job.next = 0;
+  job.done = 0;
+  job.helpers = 0;
+  job.max_helpers = num_threads - 1;
+
+  pool &p = get_pool();
+  pool_lock lock(p);
+  // Grow the pool to the largest number of helpers asked for so far. A
+  // thread that cannot be started leaves its share to the others.
+  while (p.num_workers < job.max_helpers && start_worker()) {
+    ++p.num_workers;
+  }
+  p.jobs.push_back(&job);
+  notify_work(p);
+
+  take_tasks(p, lock, job);
+  while (job.helpers || job.done < job.num_tasks) {
+    lock.wait_finished();
+  }
+}
+
+#if __cplusplus < 201100L
+static pthread_key_t md_ctx_key;
+static pthread_once_t md_ctx_key_once = PTHREAD_ONCE_INIT;
+
+static void free_md_ctx(void *mdctx) {
+  EVP_MD_CTX_free(static_cast<EVP_MD_CTX *>(mdctx));
+}
+
+static void create_md_ctx_key() {
+  pthread_key_create(&md_ctx_key, free_md_ctx);
+}
+
+EVP_MD_CTX *get_thread_md_ctx() {
+  pthread_once(&md_ctx_key_once, create_md_ctx_key);
+  EVP_MD_CTX *mdctx =
+      static_cast<EVP_MD_CTX *>(pthread_getspecific(md_ctx_key));
+  if (!mdctx) {
+    mdctx = EVP_MD_CTX_new();
+    if (mdctx && pthread_setspecific(md_ctx_key, mdctx) != 0) {
+      EVP_MD_CTX_free(mdctx);
+      mdctx = nullptr;
+    }
+  }
+  return mdctx;
+}
+#else
+// Frees the context of a thread when it exits.
+struct thread_md_ctx {
+  EVP_MD_CTX *mdctx;
+  ~thread_md_ctx() { EVP_MD_CTX_free(mdctx); }
+};
+
+EVP_MD_CTX *get_thread_md_ctx() {
+  static thread_local thread_md_ctx holder = {nullptr};
+  if (!holder.mdctx) {
+    holder.mdctx = EVP_MD_CTX_new();
+  }
+  return holder.mdctx;
+}
+#endif
+
+} // namespace openssl_thread_util
+
+} // namespace cryptcpp